@@ -0,0 +1,716 @@
+// Хостовый бенчмарк конвейера Kandinsky: ответ status -> StreamB64 -> tjpgd -> RenderCallback
+// Использование: kandinsky_bench <status.json | image.jpg> [-n итераций] [-f WxH] [-m fill|fit|stretch] [-s масштаб 1/2/4/8] [-e] [-c] [-l] [-o out.ppm] [-v]
+#include <Arduino.h>
+#include <malloc.h>
+
+#include <vector>
+
+#include "../src/config.h"
+#include "../src/Kandinsky/Kandinsky.h"
+
+// ================= HEAP =================
+// перехват malloc/free для подсчёта пиковой кучи (glibc)
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void __libc_free(void*);
+}
+
+namespace heap {
+static size_t cur = 0, peak = 0;
+static bool on = false;
+
+static void add(void* p) {
+    if (!p || !on) return;
+    cur += malloc_usable_size(p);
+    if (cur > peak) peak = cur;
+}
+static void sub(void* p) {
+    if (!p || !on) return;
+    size_t s = malloc_usable_size(p);
+    cur = cur > s ? cur - s : 0;
+}
+static void begin() {
+    cur = peak = 0;
+    on = true;
+}
+static size_t end() {
+    on = false;
+    return peak;
+}
+}  // namespace heap
+
+extern "C" {
+void* malloc(size_t size) {
+    void* p = __libc_malloc(size);
+    heap::add(p);
+    return p;
+}
+void* calloc(size_t n, size_t size) {
+    void* p = __libc_calloc(n, size);
+    heap::add(p);
+    return p;
+}
+void* realloc(void* ptr, size_t size) {
+    heap::sub(ptr);
+    void* p = __libc_realloc(ptr, size);
+    heap::add(p ? p : ptr);
+    return p;
+}
+void free(void* ptr) {
+    heap::sub(ptr);
+    __libc_free(ptr);
+}
+}
+
+// ================= STREAM =================
+// поток из памяти, как ответ сервера после TLS
+class MemStream : public Stream {
+   public:
+    MemStream(const uint8_t* data, size_t len, bool peek = true) : _data(data), _len(len), _peek(peek) {}
+
+    void rewind(size_t pos = 0) {
+        _pos = pos;
+    }
+    size_t pos() const {
+        return _pos;
+    }
+
+    int available() override {
+        return _len - _pos;
+    }
+    int read() override {
+        return _pos < _len ? _data[_pos++] : -1;
+    }
+    int peek() override {
+        return _pos < _len ? _data[_pos] : -1;
+    }
+    size_t readBytes(char* buffer, size_t length) override {
+        length = min(length, _len - _pos);
+        memcpy(buffer, _data + _pos, length);
+        _pos += length;
+        return length;
+    }
+    size_t write(uint8_t) override {
+        return 0;
+    }
+    using Print::write;
+
+    // peek buffer API, как у BearSSL::WiFiClientSecure. Буфер отдаётся порциями по размеру TLS записи
+    bool hasPeekBufferAPI() const override {
+        return _peek;
+    }
+    size_t peekAvailable() override {
+        return min(_len - _pos, (size_t)16384);
+    }
+    const char* peekBuffer() override {
+        return (const char*)_data + _pos;
+    }
+    void peekConsume(size_t consume) override {
+        _pos += min(consume, _len - _pos);
+    }
+
+   private:
+    const uint8_t* _data;
+    size_t _len;
+    size_t _pos = 0;
+    bool _peek;
+};
+
+// ================= TFT =================
+// дисплей на SPI: пишет пиксели в кадр по окну адресации и считает транзакции шины
+class MockTFT {
+   public:
+    void begin(uint16_t w, uint16_t h) {
+        _w = w;
+        _h = h;
+        frame.assign((size_t)w * h, 0);
+        transactions = windows = pixels = 0;
+    }
+    int16_t width() {
+        return _w;
+    }
+    int16_t height() {
+        return _h;
+    }
+    void startWrite() {
+        transactions++;
+    }
+    void endWrite() {}
+    void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t /*h*/) {
+        _x = _cx = x;
+        _cy = y;
+        _wx = x + w;
+        windows++;
+    }
+    void writePixels(const uint16_t* px, uint32_t n) {
+        pixels += n;
+        while (n--) {
+            if (_cy < _h && _cx < _w) frame[(size_t)_cy * _w + _cx] = *px;
+            px++;
+            if (++_cx >= _wx) {
+                _cx = _x;
+                _cy++;
+            }
+        }
+    }
+
+    std::vector<uint16_t> frame;
+    uint32_t transactions = 0, windows = 0, pixels = 0;
+
+   private:
+    uint16_t _w = 0, _h = 0, _x = 0, _cx = 0, _cy = 0, _wx = 0;
+};
+
+// ================= UTILS =================
+static uint64_t now_us() {
+    return micros();
+}
+
+struct Stage {
+    const char* name;
+    std::vector<uint64_t> us{};
+    size_t heap = 0;
+
+    uint64_t median() {
+        std::sort(us.begin(), us.end());
+        return us.size() ? us[us.size() / 2] : 0;
+    }
+    uint64_t best() {
+        return us.size() ? *std::min_element(us.begin(), us.end()) : 0;
+    }
+};
+
+static bool readFile(const char* path, std::vector<uint8_t>& data) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data.resize(len);
+    bool ok = fread(data.data(), 1, len, f) == (size_t)len;
+    fclose(f);
+    return ok;
+}
+
+// обернуть JPEG в ответ /key/api/v1/pipeline/status/<uuid> в том виде, в каком его отдаёт прокси
+static void wrapJpeg(std::vector<uint8_t>& data) {
+    String json(F("{\"uuid\":\"00000000-0000-0000-0000-000000000000\",\"status\":\"DONE\",\"result\":{\"files\":[\""));
+    su::b64::encode(json, data.data(), data.size());
+    json += F("\"],\"censored\":false},\"generationTime\":1}");
+    data.assign((const uint8_t*)json.c_str(), (const uint8_t*)json.c_str() + json.length());
+}
+
+// сохранить кадр RGB565 в PPM для сравнения глазами или сторонними утилитами
+static bool writePPM(const char* path, const std::vector<uint16_t>& frame, uint16_t w, uint16_t h) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    fprintf(f, "P6\n%u %u\n255\n", w, h);
+    for (size_t i = 0; i < (size_t)w * h; i++) {
+        uint16_t c = frame[i];
+        uint8_t rgb[3] = {uint8_t((c >> 8) & 0xF8), uint8_t((c >> 3) & 0xFC), uint8_t(c << 3)};
+        fwrite(rgb, 1, 3, f);
+    }
+    fclose(f);
+    return true;
+}
+
+// экранировать base64 так, как это может сделать JSON сериализатор: \/ и перенос строк \n каждые 76 символов
+static void escapeB64(std::vector<uint8_t>& data, size_t offs, size_t len) {
+    std::vector<uint8_t> esc;
+    for (size_t i = 0; i < len; i++) {
+        if (i && !(i % 76)) esc.insert(esc.end(), {'\\', 'n'});
+        if (data[offs + i] == '/') esc.push_back('\\');
+        esc.push_back(data[offs + i]);
+    }
+    data.erase(data.begin() + offs, data.begin() + offs + len);
+    data.insert(data.begin() + offs, esc.begin(), esc.end());
+}
+
+// убрать JSON экранирование из base64
+static std::vector<uint8_t> unescapeB64(const uint8_t* str, size_t len) {
+    std::vector<uint8_t> out;
+    for (size_t i = 0; i < len; i++) {
+        if (str[i] == '\\') {
+            if (++i < len && str[i] == '/') out.push_back('/');
+        } else if (!isspace(str[i])) {
+            out.push_back(str[i]);
+        }
+    }
+    return out;
+}
+
+// длина JSON строки до закрывающей кавычки с учётом экранирования
+static size_t jsonStrLen(const uint8_t* str, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (str[i] == '\\') i++;
+        else if (str[i] == '"') return i;
+    }
+    return len;
+}
+
+// наибольшая разница каналов RGB565 двух кадров
+static int maxDiff(const std::vector<uint16_t>& a, const std::vector<uint16_t>& b) {
+    if (a.size() != b.size()) return 1 << 16;
+    int d = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        d = max(d, abs((a[i] >> 11) - (b[i] >> 11)));
+        d = max(d, abs(((a[i] >> 5) & 0x3f) - ((b[i] >> 5) & 0x3f)));
+        d = max(d, abs((a[i] & 0x1f) - (b[i] & 0x1f)));
+    }
+    return d;
+}
+
+// эталонное масштабирование усреднением по площади в double. Обрезка и поля считаются так же, как в Resampler::begin
+static std::vector<uint16_t> refResample(const std::vector<uint16_t>& src, int sw, int sh, int fw, int fh, Resampler::Mode mode) {
+    auto rdiv = [](long a, long b) { return int((a + b / 2) / b); };
+    int sx = 0, sy = 0, cw = sw, ch = sh, dx = 0, dy = 0, rw = fw, rh = fh;
+    bool wider = (long)sw * fh > (long)sh * fw;
+    if (mode == Resampler::Mode::Fill) {
+        if (wider) cw = rdiv((long)sh * fw, fh);
+        else ch = rdiv((long)sw * fh, fw);
+        sx = (sw - cw) / 2;
+        sy = (sh - ch) / 2;
+    } else if (mode == Resampler::Mode::Fit) {
+        if (wider) rh = rdiv((long)sh * fw, sw);
+        else rw = rdiv((long)sw * fh, sh);
+        dx = (fw - rw) / 2;
+        dy = (fh - rh) / 2;
+    }
+    std::vector<uint16_t> out((size_t)fw * fh, 0);
+    double kx = (double)cw / rw, ky = (double)ch / rh;
+    for (int y = 0; y < rh; y++) {
+        double y0 = y * ky, y1 = (y + 1) * ky;
+        for (int x = 0; x < rw; x++) {
+            double x0 = x * kx, x1 = (x + 1) * kx;
+            double acc[3] = {0, 0, 0};
+            for (int j = (int)y0; j < y1; j++) {
+                double wy = min(y1, j + 1.0) - max(y0, (double)j);
+                for (int i = (int)x0; i < x1; i++) {
+                    double w = wy * (min(x1, i + 1.0) - max(x0, (double)i));
+                    uint16_t c = src[(size_t)(sy + j) * sw + sx + i];
+                    acc[0] += (c >> 11) * w;
+                    acc[1] += ((c >> 5) & 0x3f) * w;
+                    acc[2] += (c & 0x1f) * w;
+                }
+            }
+            double a = kx * ky;
+            out[(size_t)(dy + y) * fw + dx + x] = (lround(acc[0] / a) << 11) | (lround(acc[1] / a) << 5) | lround(acc[2] / a);
+        }
+    }
+    return out;
+}
+
+// допуски сравнения с эталоном IDCT в double (bench/ref_tjpgd.c)
+#define IDCT_MAX_ERR 1   // тот же масштаб: разница каналов RGB565 (зелёный в 5 битах)
+#define IDCT_MIN_PSNR 20  // полный размер, уменьшенный усреднением: на резких границах уменьшенный IDCT звенит
+
+// уменьшить кадр в f раз усреднением блоков f x f (на краю - неполных)
+static std::vector<uint16_t> boxDown(const std::vector<uint16_t>& src, int sw, int sh, int f, int dw, int dh) {
+    std::vector<uint16_t> out((size_t)dw * dh, 0);
+    for (int y = 0; y < dh; y++) {
+        for (int x = 0; x < dw; x++) {
+            long acc[3] = {0, 0, 0}, n = 0;
+            for (int j = y * f; j < min((y + 1) * f, sh); j++) {
+                for (int i = x * f; i < min((x + 1) * f, sw); i++) {
+                    uint16_t c = src[(size_t)j * sw + i];
+                    acc[0] += c >> 11;
+                    acc[1] += (c >> 5) & 0x3f;
+                    acc[2] += c & 0x1f;
+                    n++;
+                }
+            }
+            if (n) out[(size_t)y * dw + x] = ((acc[0] + n / 2) / n << 11) | ((acc[1] + n / 2) / n << 5) | (acc[2] + n / 2) / n;
+        }
+    }
+    return out;
+}
+
+// наибольшая разница каналов RGB565 (зелёный приведён к 5 битам)
+static int maxErr(const std::vector<uint16_t>& a, const std::vector<uint16_t>& b) {
+    if (a.size() != b.size()) return 1 << 16;
+    int e = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        e = max(e, abs((a[i] >> 11) - (b[i] >> 11)));
+        e = max(e, abs(((a[i] >> 6) & 0x1f) - ((b[i] >> 6) & 0x1f)));
+        e = max(e, abs((a[i] & 0x1f) - (b[i] & 0x1f)));
+    }
+    return e;
+}
+
+// PSNR двух кадров RGB565 по каналам, приведённым к 0..1. Одинаковые - 99 дБ
+static double psnr(const std::vector<uint16_t>& a, const std::vector<uint16_t>& b) {
+    if (a.size() != b.size() || a.empty()) return 0;
+    double se = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        double d[3] = {((a[i] >> 11) - (b[i] >> 11)) / 31.0, (((a[i] >> 5) & 0x3f) - ((b[i] >> 5) & 0x3f)) / 63.0, ((a[i] & 0x1f) - (b[i] & 0x1f)) / 31.0};
+        se += d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+    }
+    double mse = se / (a.size() * 3);
+    return mse > 0 ? min(99.0, -10 * log10(mse)) : 99;
+}
+
+// ================= TJPGD FROM MEMORY =================
+struct MemJpeg {
+    const uint8_t* data;
+    size_t len;
+    size_t pos;
+    uint32_t mcus;
+    uint16_t* frame;
+    uint16_t fw, fh;
+};
+
+static size_t mem_input_cb(JDEC* jd, uint8_t* buf, size_t len) {
+    MemJpeg* m = (MemJpeg*)jd->device;
+    len = min(len, m->len - m->pos);
+    if (buf) memcpy(buf, m->data + m->pos, len);
+    m->pos += len;
+    return len;
+}
+static int mem_output_cb(JDEC* jd, void* bitmap, JRECT* rect) {
+    MemJpeg* m = (MemJpeg*)jd->device;
+    m->mcus++;
+    if (m->frame) {
+        int w = rect->right - rect->left + 1;
+        for (int y = rect->top; y <= rect->bottom && y < m->fh; y++) {
+            memcpy(&m->frame[y * m->fw + rect->left], (uint16_t*)bitmap + (y - rect->top) * w, min(w, m->fw - rect->left) * 2);
+        }
+    }
+    return 1;
+}
+
+// эталонный tjpgd с IDCT в double (ref_tjpgd.c)
+extern "C" {
+JRESULT ref_jd_prepare(JDEC* jd, size_t (*infunc)(JDEC*, uint8_t*, size_t), void* pool, size_t sz_pool, void* dev);
+JRESULT ref_jd_decomp(JDEC* jd, int (*outfunc)(JDEC*, void*, JRECT*), uint8_t scale);
+}
+
+// ================= MAIN =================
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    int iters = 10;
+    int scale = 0;  // 0 - масштабировать в кадр, как прошивка
+    int frame_w = DISP_WIDTH, frame_h = DISP_HEIGHT;
+    Resampler::Mode mode = Resampler::Mode::Fill;
+    bool verbose = false;
+    bool escape = false;
+    bool peek = true;
+    const char* out_path = nullptr;
+    bool lut = true;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) iters = max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc) scale = max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-f") && i + 1 < argc) sscanf(argv[++i], "%dx%d", &frame_w, &frame_h);
+        else if (!strcmp(argv[i], "-m") && i + 1 < argc) {
+            i++;
+            mode = !strcmp(argv[i], "fit") ? Resampler::Mode::Fit : (!strcmp(argv[i], "stretch") ? Resampler::Mode::Stretch : Resampler::Mode::Fill);
+        }
+        else if (!strcmp(argv[i], "-v")) verbose = true;
+        else if (!strcmp(argv[i], "-e")) escape = true;
+        else if (!strcmp(argv[i], "-c")) peek = false;
+        else if (!strcmp(argv[i], "-l")) lut = false;
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc) out_path = argv[++i];
+        else path = argv[i];
+    }
+    if (!path) {
+        fprintf(stderr, "usage: %s <status.json | image.jpg> [-n iterations] [-f WxH] [-m fill|fit|stretch] [-s scale 1/2/4/8] [-e] [-c] [-l] [-o out.ppm] [-v]\n", argv[0]);
+        return 2;
+    }
+    Serial.mute(!verbose);
+
+    std::vector<uint8_t> resp;
+    if (!readFile(path, resp) || resp.size() < 4) {
+        fprintf(stderr, "can't read %s\n", path);
+        return 1;
+    }
+    if (resp[0] == 0xFF && resp[1] == 0xD8) wrapJpeg(resp);
+
+    // положение и длина base64 значения files[0]
+    const char* key = "\"files\":[\"";
+    const uint8_t* fp = std::search(resp.begin(), resp.end(), key, key + strlen(key)).base();
+    if (fp == resp.data() + resp.size()) {
+        fprintf(stderr, "no result.files in response\n");
+        return 1;
+    }
+    size_t b64_offs = fp - resp.data() + strlen(key);
+    size_t b64_len = jsonStrLen(resp.data() + b64_offs, resp.size() - b64_offs);
+    if (escape) {
+        escapeB64(resp, b64_offs, b64_len);
+        b64_len = jsonStrLen(resp.data() + b64_offs, resp.size() - b64_offs);
+    }
+    std::vector<uint8_t> clean = unescapeB64(resp.data() + b64_offs, b64_len);
+    std::vector<uint8_t> jpeg(su::b64::decodedLen(clean.data(), clean.size()));
+    su::b64::decode(jpeg.data(), clean.data(), clean.size());
+
+    Kandinsky kand;
+    if (scale) kand.setScale(scale);
+    else kand.setFrame(frame_w, frame_h, mode);
+    MockTFT tft;
+    uint64_t render_us = 0;
+    kand.onRender([&](int x, int y, int w, int h, uint8_t* buf) {
+        uint64_t t = now_us();
+        // как tft_render() в прошивке: одно окно и один пакет пикселей на вызов
+        if (x >= tft.width() || y >= tft.height()) return;
+        int cw = min(w, tft.width() - x);
+        int ch = min(h, tft.height() - y);
+        tft.startWrite();
+        tft.setAddrWindow(x, y, cw, ch);
+        if (cw == w) {
+            tft.writePixels((uint16_t*)buf, cw * ch);
+        } else {
+            for (int i = 0; i < ch; i++) tft.writePixels((uint16_t*)buf + i * w, cw);
+        }
+        tft.endWrite();
+        render_us += now_us() - t;
+    });
+
+    // память декодера выделяется один раз, как в прошивке
+    kand.allocDecoder(lut);
+    size_t pool_size = kand.decoderSize();
+
+    // кэш картинки во временной папке вместо LittleFS
+    fs::FS cachefs(P_tmpdir);
+    const char* cache_path = "kandinsky_bench.jpg";
+    cachefs.remove(cache_path);
+    kand.setCache(&cachefs, cache_path);
+
+    JDEC jdec;
+    MemJpeg mj;
+    {
+        // размер картинки для кадрового буфера
+        uint8_t* pool = new uint8_t[pool_size];
+        mj = MemJpeg{jpeg.data(), jpeg.size(), 0, 0, nullptr, 0, 0};
+        jdec.swap = 0;
+        JRESULT res = jd_prepare(&jdec, mem_input_cb, pool, pool_size, &mj);
+        delete[] pool;
+        if (res != JDR_OK) {
+            fprintf(stderr, "jd_prepare error %d\n", res);
+            return 1;
+        }
+    }
+    uint8_t jscale = 0;
+    if (scale) {
+        while ((1 << jscale) < scale && jscale < 3) jscale++;
+    } else {
+        jscale = Kandinsky::frameScale(jdec.width, jdec.height, frame_w, frame_h, mode);
+    }
+    uint16_t out_w = Kandinsky::outSize(jdec.width, jdec.msx * 8, jscale);
+    uint16_t out_h = Kandinsky::outSize(jdec.height, jdec.msy * 8, jscale);
+
+    // эталонная картинка: tjpgd напрямую из памяти, затем масштабирование в кадр в double
+    std::vector<uint16_t> dec((size_t)out_w * out_h, 0);
+    {
+        uint8_t* pool = new uint8_t[pool_size];
+        mj = MemJpeg{jpeg.data(), jpeg.size(), 0, 0, dec.data(), out_w, out_h};
+        JRESULT res = jd_prepare(&jdec, mem_input_cb, pool, pool_size, &mj);
+        if (res == JDR_OK) res = jd_decomp(&jdec, mem_output_cb, jscale);
+        delete[] pool;
+        if (res != JDR_OK) {
+            fprintf(stderr, "jpeg error %d\n", res);
+            return 1;
+        }
+    }
+
+    // независимый эталон декода - tjpgd с IDCT в double (ref_tjpgd.c):
+    // 1) в том же масштабе - уменьшенные IDCT должны совпасть с формулой NxN с точностью до округления;
+    // 2) полный размер, уменьшенный усреднением блоков 1 << jscale, - грубая проверка, что картинка та же
+    auto refDecode = [&](uint8_t sc, uint16_t w, uint16_t h, std::vector<uint16_t>& out) {
+        JDEC rdec;
+        out.assign((size_t)w * h, 0);
+        uint8_t* pool = new uint8_t[pool_size];
+        mj = MemJpeg{jpeg.data(), jpeg.size(), 0, 0, out.data(), w, h};
+        rdec.swap = 0;
+        JRESULT res = ref_jd_prepare(&rdec, mem_input_cb, pool, pool_size, &mj);
+        if (res == JDR_OK) res = ref_jd_decomp(&rdec, mem_output_cb, sc);
+        delete[] pool;
+        if (res != JDR_OK) fprintf(stderr, "reference jpeg error %d\n", res);
+        return res == JDR_OK;
+    };
+    std::vector<uint16_t> rdec, full;
+    uint16_t full_w = Kandinsky::outSize(jdec.width, jdec.msx * 8, 0);
+    uint16_t full_h = Kandinsky::outSize(jdec.height, jdec.msy * 8, 0);
+    if (!refDecode(jscale, out_w, out_h, rdec) || !refDecode(0, full_w, full_h, full)) return 1;
+    int idct_err = maxErr(dec, rdec);
+    double idct_psnr = psnr(dec, boxDown(full, full_w, full_h, 1 << jscale, out_w, out_h));
+
+    printf("input: %s\n", path);
+    printf("response: %zu B, base64: %zu B, jpeg: %zu B, %ux%u -> %ux%u (1/%d), MCU %ux%u\n",
+           resp.size(), b64_len, jpeg.size(), jdec.width, jdec.height, out_w, out_h, 1 << jscale, jdec.msx * 8, jdec.msy * 8);
+    printf("decoder pool: %zu B%s\n", pool_size, jdec.fastlut ? " (huffman LUT)" : "");
+    printf("decode vs float IDCT: max error %d (limit %d), full size 1/%d box PSNR %.1f dB (limit %d)\n",
+           idct_err, IDCT_MAX_ERR, 1 << jscale, idct_psnr, IDCT_MIN_PSNR);
+    if (idct_err > IDCT_MAX_ERR || idct_psnr < IDCT_MIN_PSNR) {
+        fprintf(stderr, "scaled IDCT does not match the float reference\n");
+        return 1;
+    }
+    uint16_t tft_w = out_w, tft_h = out_h;
+    std::vector<uint16_t> ref = dec;
+    if (!scale) {
+        static const char* modes[] = {"fill", "fit", "stretch"};
+        printf("frame: %ux%u %s, resampler %ux%u -> %ux%u\n", frame_w, frame_h, modes[(int)mode], out_w, out_h, frame_w, frame_h);
+        tft_w = frame_w;
+        tft_h = frame_h;
+        ref = refResample(dec, out_w, out_h, frame_w, frame_h, mode);
+    }
+    // целочисленный ресемплер может разойтись с double на единицу при округлении половины
+    int tolerance = scale ? 0 : 1;
+
+    Stage st_b64{"b64"}, st_prep{"jd_prepare"}, st_decomp{"jd_decomp"}, st_resample{"resample"}, st_render{"render"}, st_e2e{"e2e"}, st_cache{"cache"};
+    uint32_t mcu_count = 0;
+    bool ok = true;
+
+    for (int it = 0; it < iters && ok; it++) {
+        // 1. только base64 - как его тянет tjpgd блоками JD_SZBUF
+        {
+            MemStream ms(resp.data(), resp.size(), peek);
+            ms.rewind(b64_offs);
+            std::vector<uint8_t> out(jpeg.size() + JD_SZBUF);
+            size_t total = 0;
+            heap::begin();
+            uint64_t t = now_us();
+            {
+                StreamB64 sb(ms);
+                while (total < out.size()) {
+                    size_t n = sb.readBytes(out.data() + total, min(out.size() - total, (size_t)JD_SZBUF));
+                    if (!n) break;
+                    total += n;
+                }
+            }
+            st_b64.us.push_back(now_us() - t);
+            st_b64.heap = max(st_b64.heap, heap::end());
+            if (total != jpeg.size() || memcmp(out.data(), jpeg.data(), total)) {
+                fprintf(stderr, "b64 mismatch: decoded %zu of %zu B\n", total, jpeg.size());
+                ok = false;
+                break;
+            }
+        }
+
+        // 2. только jpeg - из декодированного буфера в памяти
+        {
+            uint8_t* pool = new uint8_t[pool_size];
+            mj = MemJpeg{jpeg.data(), jpeg.size(), 0, 0, nullptr, 0, 0};
+            heap::begin();
+            uint64_t t = now_us();
+            JRESULT res = jd_prepare(&jdec, mem_input_cb, pool, pool_size, &mj);
+            uint64_t t2 = now_us();
+            if (res == JDR_OK) res = jd_decomp(&jdec, mem_output_cb, jscale);
+            uint64_t t3 = now_us();
+            size_t h = heap::end();
+            delete[] pool;
+            if (res != JDR_OK) {
+                fprintf(stderr, "jpeg error %d\n", res);
+                ok = false;
+                break;
+            }
+            st_prep.us.push_back(t2 - t);
+            st_decomp.us.push_back(t3 - t2);
+            st_prep.heap = st_decomp.heap = max(st_prep.heap, h + pool_size);
+            mcu_count = mj.mcus;
+        }
+
+        // 2a. только ресемплер - декодированная картинка полосами по высоте MCU
+        if (!scale) {
+            Resampler rs;
+            rs.alloc(frame_w, frame_h);
+            std::vector<uint16_t> out((size_t)frame_w * frame_h, 0);
+            Resampler::Callback cb = [&](int x, int y, int w, int h, uint8_t* buf) {
+                memcpy(&out[(size_t)y * frame_w + x], buf, w * h * 2);
+            };
+            uint16_t band = (jdec.msy * 8) >> jscale;
+            heap::begin();
+            uint64_t t = now_us();
+            rs.begin(out_w, out_h, mode, false, &cb);
+            for (uint16_t y = 0; y < out_h; y += band) {
+                rs.write(y, min(band, uint16_t(out_h - y)), (uint8_t*)&dec[(size_t)y * out_w], out_w);
+            }
+            rs.end();
+            st_resample.us.push_back(now_us() - t);
+            st_resample.heap = max(st_resample.heap, heap::end());
+            int d = maxDiff(out, ref);
+            if (d > tolerance) {
+                fprintf(stderr, "resampler differs from reference by %d\n", d);
+                ok = false;
+                break;
+            }
+        }
+
+        // 3. полный конвейер через Kandinsky::parseStatus
+        {
+            tft.begin(tft_w, tft_h);
+            MemStream ms(resp.data(), resp.size(), peek);
+            StreamReader body(&ms, resp.size());  // тело ответа, как его отдаёт ghttp::Client
+            render_us = 0;
+            heap::begin();
+            uint64_t t = now_us();
+            bool res = kand.parseStatus(body);
+            uint64_t dt = now_us() - t;
+            size_t h = heap::end();
+            if (!res) {
+                fprintf(stderr, "parseStatus error: %s\n", kand.status.c_str());
+                ok = false;
+                break;
+            }
+            if (maxDiff(tft.frame, ref) > tolerance) {
+                fprintf(stderr, "e2e image differs from reference decode\n");
+                ok = false;
+                break;
+            }
+            st_e2e.us.push_back(dt);
+            st_e2e.heap = max(st_e2e.heap, h);
+            st_render.us.push_back(render_us);
+        }
+
+        // 4. перерисовка из кэша, как при загрузке
+        {
+            File f = cachefs.open(cache_path, "r");
+            std::vector<uint8_t> cached(f.size());
+            f.readBytes(cached.data(), cached.size());
+            f.close();
+            if (cached != jpeg) {
+                fprintf(stderr, "cache file differs from jpeg: %zu of %zu B\n", cached.size(), jpeg.size());
+                ok = false;
+                break;
+            }
+            tft.begin(tft_w, tft_h);
+            heap::begin();
+            uint64_t t = now_us();
+            bool res = kand.drawCache();
+            uint64_t dt = now_us() - t;
+            size_t h = heap::end();
+            if (!res || maxDiff(tft.frame, ref) > tolerance) {
+                fprintf(stderr, "cache redraw error\n");
+                ok = false;
+                break;
+            }
+            st_cache.us.push_back(dt);
+            st_cache.heap = max(st_cache.heap, h);
+        }
+    }
+    cachefs.remove(cache_path);
+    if (!ok) return 1;
+    if (out_path && !writePPM(out_path, tft.frame, tft_w, tft_h)) fprintf(stderr, "can't write %s\n", out_path);
+
+    printf("iterations: %d, MCUs/image: %u, output matches reference\n", iters, mcu_count);
+    printf("TFT/image: %u SPI transactions, %u address windows, %u px/window\n\n", tft.transactions, tft.windows, tft.windows ? tft.pixels / tft.windows : 0);
+    printf("%-12s %10s %10s %14s %12s %10s\n", "stage", "median ms", "best ms", "throughput", "MCU/s", "peak heap");
+
+    auto row = [&](Stage& s, double bytes, const char* unit, bool mcu) {
+        double med = s.median() / 1000.0;
+        double sec = s.median() / 1e6;
+        char thr[32] = "-", mps[32] = "-", hp[32] = "-";
+        if (bytes > 0 && sec > 0) snprintf(thr, sizeof(thr), "%.2f %s", bytes / sec / 1e6, unit);
+        if (mcu && sec > 0) snprintf(mps, sizeof(mps), "%.0f", mcu_count / sec);
+        if (s.heap) snprintf(hp, sizeof(hp), "%zu B", s.heap);
+        printf("%-12s %10.3f %10.3f %14s %12s %10s\n", s.name, med, s.best() / 1000.0, thr, mps, hp);
+    };
+    row(st_b64, b64_len, "MB/s b64", false);
+    row(st_prep, 0, "", false);
+    row(st_decomp, jpeg.size(), "MB/s jpg", true);
+    if (!scale) row(st_resample, (double)out_w * out_h * 2, "MB/s px", false);
+    row(st_render, (double)tft_w * tft_h * 2, "MB/s px", false);
+    row(st_e2e, b64_len, "MB/s b64", true);
+    row(st_cache, jpeg.size(), "MB/s jpg", true);
+    return 0;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <Arduino.h>
+
+// запись парсера для сверки вариантов
+struct BenchEntry {
+    uint16_t parent;
+    uint8_t type;
+    String key;
+    String value;
+
+    bool operator==(const BenchEntry& e) const {
+        return parent == e.parent && type == e.type && key == e.key && value == e.value;
+    }
+};
@@ -0,0 +1,3 @@
+// эталон: посимвольный парсер без stage 1
+#define GSON_VARIANT gson_ref
+#include "variant.h"
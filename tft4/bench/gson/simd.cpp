@@ -0,0 +1,4 @@
+// stage 1 на SIMD хоста (SSE2, AVX2 с -mavx2, NEON на aarch64)
+#define GSON_SCAN
+#define GSON_VARIANT gson_simd
+#include "variant.h"
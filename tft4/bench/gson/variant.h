@@ -0,0 +1,25 @@
+// Один вариант парсера gson в своём пространстве имён, чтобы в одном бенчмарке
+// сравнить сборки с разными настройками. Перед включением: GSON_VARIANT и настройки GSON_*
+#include <vector>
+
+#include "entries.h"
+
+#define _GSON_FN(v, f) v##_##f
+#define GSON_FN(v, f) _GSON_FN(v, f)
+
+#define gson GSON_VARIANT
+#define gsutil GSON_FN(GSON_VARIANT, util)
+#include <GSON.h>
+
+// разобрать json, при dump != nullptr - выгрузить записи для сверки
+bool GSON_FN(GSON_VARIANT, parse)(const char* json, uint16_t len, std::vector<BenchEntry>* dump) {
+    gson::Parser p;
+    if (!p.parse(json, len)) return false;
+    if (dump) {
+        dump->clear();
+        for (uint16_t i = 0; i < p.length(); i++) {
+            dump->push_back({p.parent(i), (uint8_t)p.type(i), p.key(i).toString(), p.value(i).toString()});
+        }
+    }
+    return true;
+}
@@ -0,0 +1,164 @@
+// Хостовый бенчмарк парсера gson: stage 1 на SIMD хоста (GSON_SCAN) против посимвольного парсера
+// Использование: gson_bench [file.json ...] [-n итераций]. Без файлов - синтетические документы
+#include <Arduino.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "gson/entries.h"
+
+bool gson_ref_parse(const char* json, uint16_t len, std::vector<BenchEntry>* dump);
+bool gson_simd_parse(const char* json, uint16_t len, std::vector<BenchEntry>* dump);
+
+struct Variant {
+    const char* name;
+    bool (*parse)(const char*, uint16_t, std::vector<BenchEntry>*);
+};
+static const Variant variants[] = {
+    {"ref", gson_ref_parse},
+    {"simd", gson_simd_parse},
+};
+
+struct Corpus {
+    String name;
+    String json;
+};
+
+// ================= CORPUS =================
+// стили как в ответе cdn.fusionbrain.ai/static/styles/key, pretty - с отступами
+static String styles(uint16_t n, bool pretty) {
+    const char* nl = pretty ? "\n" : "";
+    const char* t1 = pretty ? "  " : "";
+    const char* t2 = pretty ? "    " : "";
+    const char* sp = pretty ? " " : "";
+    String s = "[";
+    s += nl;
+    for (uint16_t i = 0; i < n; i++) {
+        String id(i);
+        if (i) {
+            s += ',';
+            s += nl;
+        }
+        s += t1;
+        s += '{';
+        s += nl;
+        s += String(t2) + "\"name\":" + sp + "\"STYLE_" + id + "\"," + nl;
+        s += String(t2) + "\"title\":" + sp + "\"Стиль \\\"" + id + "\\\"\"," + nl;
+        s += String(t2) + "\"titleEn\":" + sp + "\"Style " + id + "\"," + nl;
+        s += String(t2) + "\"image\":" + sp + "\"https:\\/\\/cdn.fusionbrain.ai\\/static\\/download\\/images\\/" + id + ".jpg\"," + nl;
+        s += String(t2) + "\"order\":" + sp + id + "," + nl;
+        s += String(t2) + "\"enabled\":" + sp + (i % 3 ? "true" : "false") + nl;
+        s += t1;
+        s += '}';
+    }
+    s += nl;
+    s += ']';
+    return s;
+}
+
+// числовые массивы
+static String numbers(uint16_t n) {
+    String s = "{\"data\":[";
+    for (uint16_t i = 0; i < n; i++) {
+        if (i) s += ',';
+        s += '[';
+        for (uint8_t j = 0; j < 8; j++) {
+            if (j) s += ',';
+            s += String((int32_t)(i * 7919 + j * 104729) % 200000 - 100000);
+            if (j & 1) s += ".25";
+        }
+        s += ']';
+    }
+    s += "],\"count\":" + String(n) + "}";
+    return s;
+}
+
+// ответ status с картинкой: одна длинная строка
+static String status(uint16_t len) {
+    String s = "{\"uuid\":\"00000000-0000-0000-0000-000000000000\",\"status\":\"DONE\",\"result\":{\"files\":[\"";
+    static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (uint16_t i = 0; i < len; i++) s += b64[(i * 31 + (i >> 5)) & 63];
+    s += "\"],\"censored\":false},\"errorDescription\":null,\"statusTime\":1700000000}";
+    return s;
+}
+
+static bool readFile(const char* path, String& s) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f))) s.concat(buf, n);
+    fclose(f);
+    return true;
+}
+
+// ================= MAIN =================
+int main(int argc, char** argv) {
+    int iters = 200;
+    std::vector<Corpus> corpora;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            iters = atoi(argv[++i]);
+        } else {
+            Corpus c{argv[i], ""};
+            if (!readFile(argv[i], c.json)) {
+                fprintf(stderr, "can't read %s\n", argv[i]);
+                return 1;
+            }
+            corpora.push_back(c);
+        }
+    }
+    if (corpora.empty()) {
+        corpora.push_back({"styles", styles(300, false)});
+        corpora.push_back({"styles pretty", styles(300, true)});
+        corpora.push_back({"numbers", numbers(600)});
+        corpora.push_back({"status", status(60000)});
+    }
+
+    printf("%-14s %8s %8s %-8s %10s %10s %8s\n", "corpus", "bytes", "entries", "parser", "median us", "MB/s", "vs ref");
+    bool ok = true;
+    for (Corpus& c : corpora) {
+        if (c.json.length() >= 0xffff) {
+            fprintf(stderr, "%s: %u B, gson limit is 65535 B\n", c.name.c_str(), c.json.length());
+            ok = false;
+            continue;
+        }
+        const char* json = c.json.c_str();
+        uint16_t len = c.json.length();
+
+        // все варианты дают одинаковые записи
+        std::vector<BenchEntry> ref, out;
+        if (!gson_ref_parse(json, len, &ref)) {
+            fprintf(stderr, "%s: parse error\n", c.name.c_str());
+            ok = false;
+            continue;
+        }
+        double ref_us = 0;
+        for (const Variant& v : variants) {
+            if (!v.parse(json, len, &out) || out != ref) {
+                fprintf(stderr, "%s: %s differs from ref\n", c.name.c_str(), v.name);
+                ok = false;
+                continue;
+            }
+            // замер пачками не короче миллисекунды, micros() шага 1 мкс
+            uint32_t batch = 1;
+            while (true) {
+                uint32_t t = micros();
+                for (uint32_t k = 0; k < batch; k++) v.parse(json, len, nullptr);
+                if (micros() - t >= 1000) break;
+                batch *= 2;
+            }
+            std::vector<double> us;
+            for (int i = 0; i < iters; i++) {
+                uint32_t t = micros();
+                for (uint32_t k = 0; k < batch; k++) v.parse(json, len, nullptr);
+                us.push_back((double)(micros() - t) / batch);
+            }
+            std::sort(us.begin(), us.end());
+            double med = us[us.size() / 2];
+            if (!ref_us) ref_us = med;
+            printf("%-14s %8u %8zu %-8s %10.2f %10.1f %7.2fx\n", c.name.c_str(), len, ref.size(), v.name, med, len / med, ref_us / med);
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+#pragma once
+// прежний разбор заголовков ghttp: строки через readStringUntil в String, лог в Serial.
+// Код ответа - из стартовой строки, как в прежнем ghttp::Client::getResponse
+#include <Arduino.h>
+#include <StringUtils.h>
+
+#define GHTTP_HEADERS_LOG Serial
+
+namespace legacy {
+
+class HeadersParser {
+   public:
+    template <typename client_t>
+    HeadersParser(client_t& client) {
+        String lineStr = client.readStringUntil('\n');
+        Text lines[3];
+        Text(lineStr).split(lines, 3, ' ');
+        code = lines[1].toInt();
+
+        contentType.reserve(50);
+        String buf;
+
+        while (true) {
+            buf = client.readStringUntil('\n');
+            size_t n = buf.length();
+
+            if (!n || buf[n - 1] != '\r') 
+            {
+                GHTTP_HEADERS_LOG.println("break " + buf);
+                break;  // пустая или не оканчивается на \r
+            }
+            if (n == 1) {                         // == \r
+                GHTTP_HEADERS_LOG.println("valid");
+                valid = true;
+                break;
+            }
+
+            Text header(buf.c_str(), n - 1);
+
+#ifdef GHTTP_HEADERS_LOG
+            GHTTP_HEADERS_LOG.println(header);
+#endif
+
+            int16_t colon = header.indexOf(':');
+            if (colon > 0) {
+                Text name = header.substring(0, colon);
+                Text value = header.substring(colon + 1).trim();
+
+                switch (name.hash()) {
+                    case SH("Content-Type"): value.addString(contentType); break;
+                    case SH("Content-Length"): length = value.toInt32(); break;
+                    case SH("Transfer-Encoding"): chunked = (value == F("chunked")); break;
+                    case SH("Connection"): close = (value == F("close")); break;
+                }
+            }
+        }
+    }
+
+    String contentType;
+    size_t length = 0;
+    uint16_t code = 0;
+    bool close = false;
+    bool valid = false;
+    bool chunked = false;
+};
+
+}  // namespace legacy
+
+#undef GHTTP_HEADERS_LOG
@@ -0,0 +1,342 @@
+// Хостовый бенчмарк разбора заголовков ghttp: HeadersParser против прежнего разбора через String
+// Использование: headers_bench [response.txt ...] [-n итераций]. Файл - ответ целиком (curl -si), без файлов - встроенные ответы
+#include <Arduino.h>
+#include <malloc.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "GyverHTTP.h"
+#include "headers/legacy.h"
+
+// ================= HEAP =================
+// перехват malloc: число выделений за разбор
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_realloc(void*, size_t);
+}
+
+namespace heap {
+static size_t allocs = 0;
+}
+
+extern "C" {
+void* malloc(size_t size) {
+    heap::allocs++;
+    return __libc_malloc(size);
+}
+void* realloc(void* ptr, size_t size) {
+    heap::allocs++;
+    return __libc_realloc(ptr, size);
+}
+}
+
+// ================= STREAM =================
+// ответ из памяти. peek - буфер отдаётся порциями по размеру записи TLS, как у BearSSL::WiFiClientSecure
+class MemStream : public Stream {
+   public:
+    MemStream(const String& data, bool peek) : _data(data.c_str()), _len(data.length()), _peek(peek) {
+        setTimeout(0);
+    }
+
+    void rewind() {
+        _pos = 0;
+    }
+    size_t pos() const {
+        return _pos;
+    }
+
+    int available() override {
+        return _len - _pos;
+    }
+    int read() override {
+        return _pos < _len ? (uint8_t)_data[_pos++] : -1;
+    }
+    int peek() override {
+        return _pos < _len ? (uint8_t)_data[_pos] : -1;
+    }
+    size_t readBytes(char* buffer, size_t length) override {
+        length = min(length, _len - _pos);
+        memcpy(buffer, _data + _pos, length);
+        _pos += length;
+        return length;
+    }
+    size_t write(uint8_t) override {
+        return 0;
+    }
+    using Print::write;
+
+    bool hasPeekBufferAPI() const override {
+        return _peek;
+    }
+    size_t peekAvailable() override {
+        return _peek ? min(_len - _pos, (size_t)512) : 0;
+    }
+    const char* peekBuffer() override {
+        return _data + _pos;
+    }
+    void peekConsume(size_t consume) override {
+        _pos += min(consume, _len - _pos);
+    }
+
+   private:
+    const char* _data;
+    size_t _len;
+    size_t _pos = 0;
+    bool _peek;
+};
+
+// ================= CORPUS =================
+// типичные ответы серверов проекта: заголовки как у этих хостов, тело - заглушка
+struct Corpus {
+    String name;
+    String resp;
+};
+
+static String body(size_t len) {
+    String s;
+    for (size_t i = 0; i < len; i++) s += (char)('a' + i % 26);
+    return s;
+}
+
+static std::vector<Corpus> builtin() {
+    std::vector<Corpus> c;
+    c.push_back({"status", String(
+                               "HTTP/1.1 200 OK\r\n"
+                               "Server: nginx\r\n"
+                               "Date: Sat, 17 Oct 2026 10:00:00 GMT\r\n"
+                               "Content-Type: application/json\r\n"
+                               "Content-Length: 64\r\n"
+                               "Connection: keep-alive\r\n"
+                               "Vary: Origin\r\n"
+                               "Vary: Access-Control-Request-Method\r\n"
+                               "Vary: Access-Control-Request-Headers\r\n"
+                               "X-Content-Type-Options: nosniff\r\n"
+                               "X-XSS-Protection: 0\r\n"
+                               "Cache-Control: no-cache, no-store, max-age=0, must-revalidate\r\n"
+                               "Pragma: no-cache\r\n"
+                               "Expires: 0\r\n"
+                               "Strict-Transport-Security: max-age=31536000 ; includeSubDomains\r\n"
+                               "X-Frame-Options: DENY\r\n"
+                               "\r\n") +
+                               body(64)});
+    c.push_back({"run", String(
+                            "HTTP/1.1 201 Created\r\n"
+                            "Server: nginx\r\n"
+                            "Date: Sat, 17 Oct 2026 10:00:00 GMT\r\n"
+                            "Content-Type: application/json\r\n"
+                            "Transfer-Encoding: chunked\r\n"
+                            "Connection: keep-alive\r\n"
+                            "Vary: Origin\r\n"
+                            "X-Content-Type-Options: nosniff\r\n"
+                            "Cache-Control: no-cache, no-store, max-age=0, must-revalidate\r\n"
+                            "Strict-Transport-Security: max-age=31536000 ; includeSubDomains\r\n"
+                            "\r\n"
+                            "40\r\n") +
+                            body(64) + "\r\n0\r\n\r\n"});
+    c.push_back({"cdn lower", String(
+                                  "HTTP/1.1 200 OK\r\n"
+                                  "content-type: application/json; charset=utf-8\r\n"
+                                  "content-length: 128\r\n"
+                                  "connection: close\r\n"
+                                  "date: Sat, 17 Oct 2026 10:00:00 GMT\r\n"
+                                  "last-modified: Mon, 12 Oct 2026 08:30:00 GMT\r\n"
+                                  "etag: \"5f1c2d3e4b5a69788796a5b4c3d2e1f0\"\r\n"
+                                  "x-amz-server-side-encryption: AES256\r\n"
+                                  "accept-ranges: bytes\r\n"
+                                  "server: AmazonS3\r\n"
+                                  "x-cache: Hit from cloudfront\r\n"
+                                  "via: 1.1 2f3e4d5c6b7a8e9f0a1b2c3d4e5f6a7b.cloudfront.net (CloudFront)\r\n"
+                                  "x-amz-cf-pop: FRA56-P4\r\n"
+                                  "x-amz-cf-id: Ab1Cd2Ef3Gh4Ij5Kl6Mn7Op8Qr9St0Uv1Wx2Yz3Ab4Cd5Ef6Gh7Ij==\r\n"
+                                  "age: 3127\r\n"
+                                  "\r\n") +
+                                  body(128)});
+    c.push_back({"github", String(
+                               "HTTP/1.1 200 OK\r\n"
+                               "Connection: keep-alive\r\n"
+                               "Content-Length: 212\r\n"
+                               "Cache-Control: max-age=300\r\n"
+                               "Content-Security-Policy: default-src 'none'; style-src 'unsafe-inline'; sandbox\r\n"
+                               "Content-Type: text/plain; charset=utf-8\r\n"
+                               "ETag: W/\"8e1d6f3c0b7a4e2d9c5f1a0b3e7d2c6a9f4b8e1d6c3a0f7b2e5d9c4a1f8b3e6d\"\r\n"
+                               "Strict-Transport-Security: max-age=31536000\r\n"
+                               "X-Content-Type-Options: nosniff\r\n"
+                               "X-Frame-Options: deny\r\n"
+                               "X-XSS-Protection: 1; mode=block\r\n"
+                               "X-GitHub-Request-Id: 3A4B:5C6D:7E8F90:A1B2C3:6701F2E3\r\n"
+                               "Accept-Ranges: bytes\r\n"
+                               "Date: Sat, 17 Oct 2026 10:00:00 GMT\r\n"
+                               "Via: 1.1 varnish\r\n"
+                               "X-Served-By: cache-fra-eddf8230045-FRA\r\n"
+                               "X-Cache: HIT\r\n"
+                               "X-Cache-Hits: 1\r\n"
+                               "X-Timer: S1760695200.123456,VS0,VE1\r\n"
+                               "Vary: Authorization,Accept-Encoding,Origin\r\n"
+                               "Access-Control-Allow-Origin: *\r\n"
+                               "Cross-Origin-Resource-Policy: cross-origin\r\n"
+                               "X-Fastly-Request-ID: 0a1b2c3d4e5f60718293a4b5c6d7e8f901234567\r\n"
+                               "Expires: Sat, 17 Oct 2026 10:05:00 GMT\r\n"
+                               "Source-Age: 0\r\n"
+                               "\r\n") +
+                               body(212)});
+    c.push_back({"error", String(
+                              "HTTP/1.1 401 Unauthorized\r\n"
+                              "Server: nginx\r\n"
+                              "Content-Type: application/json\r\n"
+                              "Content-Length: 32\r\n"
+                              "Connection: close\r\n"
+                              "\r\n") +
+                              body(32)});
+    return c;
+}
+
+static bool readFile(const char* path, String& s) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f))) s.concat(buf, n);
+    fclose(f);
+    return true;
+}
+
+// ================= RUN =================
+struct Result {
+    String type;
+    size_t length = 0;
+    size_t pos = 0;  // где остался поток: начало тела
+    uint16_t code = 0;
+    bool valid = false, chunked = false, close = false;
+
+    bool operator==(const Result& r) const {
+        return type == r.type && length == r.length && pos == r.pos && code == r.code && valid == r.valid && chunked == r.chunked && close == r.close;
+    }
+};
+
+static Result parseNew(MemStream& s) {
+    ghttp::HeadersParser h(nullptr, true);
+    h.read(s);
+    Result r;
+    r.type = h.contentType;
+    r.length = h.length;
+    r.pos = s.pos();
+    r.code = h.code;
+    r.valid = h.valid;
+    r.chunked = h.chunked;
+    r.close = h.close;
+    return r;
+}
+
+static Result parseLegacy(MemStream& s) {
+    legacy::HeadersParser h(s);
+    Result r;
+    r.type = h.contentType;
+    r.length = h.length;
+    r.pos = s.pos();
+    r.code = h.code;
+    r.valid = h.valid;
+    r.chunked = h.chunked;
+    r.close = h.close;
+    return r;
+}
+
+static void print(const char* name, const Result& r) {
+    printf("  %-7s code %u type \"%s\" length %zu chunked %d close %d valid %d body at %zu\n", name, r.code, r.type.c_str(), r.length, r.chunked, r.close, r.valid, r.pos);
+}
+
+struct Parser {
+    const char* name;
+    bool peek;
+    bool legacy;
+};
+static const Parser parsers[] = {
+    {"legacy", false, true},
+    {"copy", false, false},
+    {"peek", true, false},
+};
+
+// медиана одного разбора, мкс, и выделений за разбор
+static double measure(const Parser& p, MemStream& s, int iters, size_t& allocs) {
+    auto run = [&]() {
+        s.rewind();
+        if (p.legacy) {
+            legacy::HeadersParser h(s);
+        } else {
+            ghttp::HeadersParser h(nullptr, true);
+            h.read(s);
+        }
+    };
+    heap::allocs = 0;
+    run();
+    allocs = heap::allocs;
+
+    uint32_t batch = 1;
+    while (true) {
+        uint32_t t = micros();
+        for (uint32_t k = 0; k < batch; k++) run();
+        if (micros() - t >= 1000) break;
+        batch *= 2;
+    }
+    std::vector<double> us;
+    for (int i = 0; i < iters; i++) {
+        uint32_t t = micros();
+        for (uint32_t k = 0; k < batch; k++) run();
+        us.push_back((double)(micros() - t) / batch);
+    }
+    std::sort(us.begin(), us.end());
+    return us[us.size() / 2];
+}
+
+int main(int argc, char** argv) {
+    Serial.mute(true);
+    int iters = 200;
+    std::vector<Corpus> corpora;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            iters = atoi(argv[++i]);
+        } else {
+            Corpus c{argv[i], ""};
+            if (!readFile(argv[i], c.resp)) {
+                fprintf(stderr, "can't read %s\n", argv[i]);
+                return 1;
+            }
+            corpora.push_back(c);
+        }
+    }
+    if (corpora.empty()) corpora = builtin();
+
+    printf("%-12s %6s %-8s %10s %8s %8s\n", "response", "bytes", "parser", "median us", "allocs", "vs legacy");
+    bool ok = true;
+    for (Corpus& c : corpora) {
+        MemStream copy(c.resp, false), peek(c.resp, true);
+        Result res = parseNew(copy);
+        Result rpeek = parseNew(peek);
+        copy.rewind();
+        Result rleg = parseLegacy(copy);
+        if (!res.valid || !(res == rpeek)) {
+            fprintf(stderr, "%s: parse error\n", c.name.c_str());
+            print("copy", res);
+            print("peek", rpeek);
+            ok = false;
+            continue;
+        }
+        // прежний разбор сравнивал имена с учётом регистра - расхождение только выводится
+        if (!(res == rleg)) {
+            printf("%s: legacy differs\n", c.name.c_str());
+            print("new", res);
+            print("legacy", rleg);
+        }
+
+        double leg_us = 0;
+        for (const Parser& p : parsers) {
+            MemStream& s = p.peek ? peek : copy;
+            size_t allocs;
+            double us = measure(p, s, iters, allocs);
+            if (p.legacy) leg_us = us;
+            printf("%-12s %6u %-8s %10.3f %8zu %7.2fx\n", c.name.c_str(), c.resp.length(), p.name, us, allocs, leg_us / us);
+            if (!p.legacy && allocs) ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,38 @@
+// Эталонный декодер для проверки уменьшенных IDCT (-s 2/4/8 и масштабирование в кадр): тот же tjpgd,
+// но IDCT блока - прямая формула в double, без арифметики Arai и без block_idct4/block_idct2.
+// Функции переименованы (ref_jd_*), чтобы жить рядом с проверяемым декодером
+#include <math.h>
+
+#define jd_prepare ref_jd_prepare
+#define jd_decomp ref_jd_decomp
+#define jd_decomp_init ref_jd_decomp_init
+#define jd_decomp_mcus ref_jd_decomp_mcus
+#define JD_REF_IDCT ref_block_idct
+
+#pragma GCC diagnostic ignored "-Wunused-function"  // block_idct* здесь не вызываются
+#include "../src/Kandinsky/tjpgd/tjpgd.c"
+
+// src - деквантованные коэффициенты, умноженные на Ipsf / 256 (множители Arai), n - сторона выходного блока (8, 4, 2).
+// При n < 8 берётся угол NxN коэффициентов и считается в центрах пикселей уменьшенного блока - то, что должны давать
+// block_idct4/block_idct2. Выход - как у block_idct*
+void ref_block_idct(int32_t* src, jd_yuv_t* dst, unsigned int n) {
+    double f[64], cs[8][8];
+    for (int i = 0; i < 64; i++) f[i] = src[i] * 256.0 / Ipsf[i];
+    for (unsigned x = 0; x < n; x++) {
+        for (unsigned u = 0; u < n; u++) cs[x][u] = (u ? 1.0 : M_SQRT1_2) * cos((2 * x + 1) * u * M_PI / (2 * n));
+    }
+    for (unsigned y = 0; y < n; y++) {
+        for (unsigned x = 0; x < n; x++) {
+            double s = 0;
+            for (unsigned v = 0; v < n; v++) {
+                for (unsigned u = 0; u < n; u++) s += cs[x][u] * cs[y][v] * f[v * 8 + u];
+            }
+            long p = lround(s / 4 + 128);
+#if JD_FASTDECODE >= 1
+            dst[y * n + x] = (jd_yuv_t)p;
+#else
+            dst[y * n + x] = (jd_yuv_t)(p < 0 ? 0 : (p > 255 ? 255 : p));
+#endif
+        }
+    }
+}
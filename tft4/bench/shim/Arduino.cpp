@@ -0,0 +1,397 @@
+#include <Arduino.h>
+#include <stdarg.h>
+#include <time.h>
+
+// ================= TIME =================
+static uint64_t _now_us() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+}
+static const uint64_t _start_us = _now_us();
+
+unsigned long millis() {
+    return (_now_us() - _start_us) / 1000;
+}
+unsigned long micros() {
+    return _now_us() - _start_us;
+}
+void delay(unsigned long ms) {
+    timespec ts{(time_t)(ms / 1000), (long)(ms % 1000) * 1000000l};
+    nanosleep(&ts, nullptr);
+}
+void delayMicroseconds(unsigned int us) {
+    timespec ts{(time_t)(us / 1000000), (long)(us % 1000000) * 1000l};
+    nanosleep(&ts, nullptr);
+}
+void yield() {}
+
+long random(long max) {
+    return max ? (::random() % max) : 0;
+}
+long random(long min, long max) {
+    return min >= max ? min : min + random(max - min);
+}
+
+// ================= NONISO =================
+extern "C" {
+char* ultoa(unsigned long val, char* s, int radix) {
+    char tmp[sizeof(long) * 8 + 1];
+    char* p = tmp;
+    if (radix < 2 || radix > 36) radix = 10;
+    do {
+        int d = val % radix;
+        *p++ = d < 10 ? '0' + d : 'a' + d - 10;
+        val /= radix;
+    } while (val);
+    char* o = s;
+    while (p != tmp) *o++ = *--p;
+    *o = 0;
+    return s;
+}
+char* ltoa(long val, char* s, int radix) {
+    if (val < 0 && radix == 10) {
+        *s = '-';
+        ultoa(-(unsigned long)val, s + 1, radix);
+        return s;
+    }
+    return ultoa((unsigned long)val, s, radix);
+}
+char* utoa(unsigned int val, char* s, int radix) {
+    return ultoa(val, s, radix);
+}
+char* itoa(int val, char* s, int radix) {
+    return ltoa(val, s, radix);
+}
+char* dtostrf(double number, signed char width, unsigned char prec, char* s) {
+    sprintf(s, "%*.*f", width, prec, number);
+    return s;
+}
+#ifdef SHIM_STRLCPY
+size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = 0;
+    }
+    return len;
+}
+#endif
+}
+
+// ================= SERIAL =================
+HardwareSerial Serial;
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (!_mute) fputc(c, stderr);
+    return 1;
+}
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    if (!_mute) fwrite(buffer, 1, size, stderr);
+    return size;
+}
+
+// ================= STRING =================
+static void _num(char* buf, size_t size, unsigned long long v, bool neg, unsigned char base) {
+    char tmp[66];
+    char* p = tmp + sizeof(tmp) - 1;
+    *p = 0;
+    if (base < 2) base = 10;
+    do {
+        uint8_t d = v % base;
+        *--p = d < 10 ? '0' + d : 'A' + d - 10;
+        v /= base;
+    } while (v);
+    if (neg) *--p = '-';
+    snprintf(buf, size, "%s", p);
+}
+static void _snum(char* buf, size_t size, long long v, unsigned char base) {
+    if (v < 0 && base == 10) _num(buf, size, -(unsigned long long)v, true, base);
+    else _num(buf, size, (unsigned long long)v, false, base);
+}
+
+String::String(unsigned char v, unsigned char base) : String((unsigned long long)v, base) {}
+String::String(int v, unsigned char base) : String((long long)v, base) {}
+String::String(unsigned int v, unsigned char base) : String((unsigned long long)v, base) {}
+String::String(long v, unsigned char base) : String((long long)v, base) {}
+String::String(unsigned long v, unsigned char base) : String((unsigned long long)v, base) {}
+String::String(long long v, unsigned char base) {
+    char b[68];
+    _snum(b, sizeof(b), v, base);
+    *this = b;
+}
+String::String(unsigned long long v, unsigned char base) {
+    char b[68];
+    _num(b, sizeof(b), v, false, base);
+    *this = b;
+}
+String::String(float v, unsigned char dec) : String((double)v, dec) {}
+String::String(double v, unsigned char dec) {
+    char b[64];
+    snprintf(b, sizeof(b), "%.*f", dec, v);
+    *this = b;
+}
+
+bool String::reserve(size_t size) {
+    if (buf && cap >= size) return true;
+    char* nb = (char*)realloc(buf, size + 1);
+    if (!nb) return false;
+    if (!buf) nb[0] = 0;
+    buf = nb;
+    cap = size;
+    return true;
+}
+void String::invalidate() {
+    free(buf);
+    buf = nullptr;
+    len = cap = 0;
+}
+String& String::copy(const char* cstr, size_t length) {
+    if (!reserve(length)) {
+        invalidate();
+        return *this;
+    }
+    memmove(buf, cstr, length);
+    len = length;
+    buf[len] = 0;
+    return *this;
+}
+void String::move(String& rhs) noexcept {
+    buf = rhs.buf;
+    len = rhs.len;
+    cap = rhs.cap;
+    rhs.buf = nullptr;
+    rhs.len = rhs.cap = 0;
+}
+bool String::concat(const char* cstr, size_t length) {
+    if (!cstr) return false;
+    if (!length) return reserve(len);
+    size_t newlen = len + length;
+    if (newlen > cap) {
+        // внутренний указатель cstr может жить в нашем же буфере
+        size_t offs = (buf && cstr >= buf && cstr < buf + len) ? cstr - buf : (size_t)-1;
+        if (!reserve(std::max(newlen, cap * 3 / 2))) return false;
+        if (offs != (size_t)-1) cstr = buf + offs;
+    }
+    memmove(buf + len, cstr, length);
+    len = newlen;
+    buf[len] = 0;
+    return true;
+}
+bool String::concat(unsigned char v) {
+    return concat(String(v));
+}
+bool String::concat(int v) {
+    return concat(String(v));
+}
+bool String::concat(unsigned int v) {
+    return concat(String(v));
+}
+bool String::concat(long v) {
+    return concat(String(v));
+}
+bool String::concat(unsigned long v) {
+    return concat(String(v));
+}
+bool String::concat(long long v) {
+    return concat(String(v));
+}
+bool String::concat(unsigned long long v) {
+    return concat(String(v));
+}
+bool String::concat(float v) {
+    return concat(String(v));
+}
+bool String::concat(double v) {
+    return concat(String(v));
+}
+
+int String::compareTo(const String& s) const {
+    return strcmp(buffer(), s.buffer());
+}
+bool String::equals(const char* cstr) const {
+    return strcmp(buffer(), cstr ? cstr : "") == 0;
+}
+bool String::equalsIgnoreCase(const String& s) const {
+    return len == s.len && strcasecmp(buffer(), s.buffer()) == 0;
+}
+bool String::startsWith(const String& p) const {
+    return p.len <= len && !strncmp(buffer(), p.buffer(), p.len);
+}
+bool String::endsWith(const String& s) const {
+    return s.len <= len && !strcmp(buffer() + len - s.len, s.buffer());
+}
+char& String::operator[](unsigned int index) {
+    static char dummy;
+    if (index >= len) return dummy = 0;
+    return buf[index];
+}
+void String::toCharArray(char* out, unsigned int bufsize, unsigned int index) const {
+    if (!bufsize || !out) return;
+    if (index >= len) {
+        out[0] = 0;
+        return;
+    }
+    unsigned int n = std::min<unsigned int>(bufsize - 1, len - index);
+    memcpy(out, buffer() + index, n);
+    out[n] = 0;
+}
+int String::indexOf(char ch, unsigned int from) const {
+    if (from >= len) return -1;
+    const char* p = (const char*)memchr(buffer() + from, ch, len - from);
+    return p ? p - buffer() : -1;
+}
+int String::indexOf(const String& s, unsigned int from) const {
+    if (from >= len) return -1;
+    const char* p = strstr(buffer() + from, s.buffer());
+    return p ? p - buffer() : -1;
+}
+int String::lastIndexOf(char ch) const {
+    const char* p = strrchr(buffer(), ch);
+    return p ? p - buffer() : -1;
+}
+String String::substring(unsigned int b, unsigned int e) const {
+    if (b > e) std::swap(b, e);
+    if (b >= len) return String();
+    if (e > len) e = len;
+    return String(buffer() + b, e - b);
+}
+void String::replace(char find, char rep) {
+    for (size_t i = 0; i < len; i++) {
+        if (buf[i] == find) buf[i] = rep;
+    }
+}
+void String::remove(unsigned int index, unsigned int count) {
+    if (index >= len) return;
+    if (count > len - index) count = len - index;
+    memmove(buf + index, buf + index + count, len - index - count);
+    len -= count;
+    buf[len] = 0;
+}
+void String::toLowerCase() {
+    for (size_t i = 0; i < len; i++) buf[i] = tolower(buf[i]);
+}
+void String::toUpperCase() {
+    for (size_t i = 0; i < len; i++) buf[i] = toupper(buf[i]);
+}
+void String::trim() {
+    if (!len) return;
+    size_t b = 0, e = len;
+    while (b < e && isspace((uint8_t)buf[b])) b++;
+    while (e > b && isspace((uint8_t)buf[e - 1])) e--;
+    memmove(buf, buf + b, e - b);
+    len = e - b;
+    buf[len] = 0;
+}
+long String::toInt() const {
+    return atol(buffer());
+}
+float String::toFloat() const {
+    return atof(buffer());
+}
+double String::toDouble() const {
+    return atof(buffer());
+}
+
+// ================= PRINT =================
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+        if (!write(*buffer++)) break;
+        n++;
+    }
+    return n;
+}
+size_t Print::printf(const char* format, ...) {
+    char b[256];
+    va_list arg;
+    va_start(arg, format);
+    int len = vsnprintf(b, sizeof(b), format, arg);
+    va_end(arg);
+    if (len < 0) return 0;
+    return write((const uint8_t*)b, std::min<size_t>(len, sizeof(b) - 1));
+}
+size_t Print::print(long n, int base) {
+    return print(String((long long)n, base));
+}
+size_t Print::print(unsigned long n, int base) {
+    return print(String((unsigned long long)n, base));
+}
+size_t Print::print(long long n, int base) {
+    return print(String(n, base));
+}
+size_t Print::print(unsigned long long n, int base) {
+    return print(String(n, base));
+}
+size_t Print::print(double n, int digits) {
+    return print(String(n, digits));
+}
+
+// ================= STREAM =================
+int Stream::timedRead() {
+    unsigned long start = millis();
+    do {
+        int c = read();
+        if (c >= 0) return c;
+        yield();
+    } while (millis() - start < _timeout);
+    return -1;
+}
+int Stream::timedPeek() {
+    unsigned long start = millis();
+    do {
+        int c = peek();
+        if (c >= 0) return c;
+        yield();
+    } while (millis() - start < _timeout);
+    return -1;
+}
+bool Stream::find(const char* target) {
+    return find(target, strlen(target));
+}
+bool Stream::find(const char* target, size_t length) {
+    if (!length) return true;
+    size_t idx = 0;
+    int c;
+    while ((c = timedRead()) >= 0) {
+        if (c == target[idx]) {
+            if (++idx == length) return true;
+        } else {
+            idx = (c == target[0]) ? 1 : 0;
+        }
+    }
+    return false;
+}
+size_t Stream::readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = timedRead();
+        if (c < 0) break;
+        *buffer++ = (char)c;
+        count++;
+    }
+    return count;
+}
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length) {
+    size_t index = 0;
+    while (index < length) {
+        int c = timedRead();
+        if (c < 0 || c == terminator) break;
+        *buffer++ = (char)c;
+        index++;
+    }
+    return index;
+}
+String Stream::readString() {
+    String ret;
+    int c;
+    while ((c = timedRead()) >= 0) ret += (char)c;
+    return ret;
+}
+String Stream::readStringUntil(char terminator) {
+    String ret;
+    int c;
+    while ((c = timedRead()) >= 0 && c != terminator) ret += (char)c;
+    return ret;
+}
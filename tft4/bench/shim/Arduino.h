@@ -0,0 +1,69 @@
+#pragma once
+// Минимальная прослойка Arduino API для сборки проекта на хосте (Linux)
+#include <ctype.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <functional>
+
+#include "Client.h"
+#include "IPAddress.h"
+#include "Print.h"
+#include "Printable.h"
+#include "Stream.h"
+#include "WString.h"
+#include "pgmspace.h"
+#include "stdlib_noniso.h"
+
+using std::max;
+using std::min;
+
+#define HIGH 1
+#define LOW 0
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+long random(long max);
+long random(long min, long max);
+
+// Serial печатает в stderr, чтобы не смешиваться с отчётом бенчмарка
+class HardwareSerial : public Stream {
+   public:
+    void begin(unsigned long) {}
+    void end() {}
+    int available() override {
+        return 0;
+    }
+    int read() override {
+        return -1;
+    }
+    int peek() override {
+        return -1;
+    }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+    // заглушить вывод (логи FUS_LOG/HC_LOG мешают замерам)
+    void mute(bool m) {
+        _mute = m;
+    }
+
+   private:
+    bool _mute = false;
+};
+
+extern HardwareSerial Serial;
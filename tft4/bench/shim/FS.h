@@ -0,0 +1,127 @@
+#pragma once
+#include <stdio.h>
+
+#include "Stream.h"
+#include "WString.h"
+
+// fs::FS и fs::File в объёме, который используют проект и библиотеки Gyver. Файлы лежат в папке root
+namespace fs {
+
+class File : public Stream {
+   public:
+    File(FILE* f = nullptr) : _f(f) {}
+    File(const File&) = delete;
+    File(File&& rval) noexcept : _f(rval._f) {
+        rval._f = nullptr;
+    }
+    File& operator=(File&& rval) noexcept {
+        if (this != &rval) {
+            close();
+            _f = rval._f;
+            rval._f = nullptr;
+        }
+        return *this;
+    }
+    ~File() {
+        close();
+    }
+
+    explicit operator bool() const {
+        return _f;
+    }
+    void close() {
+        if (_f) fclose(_f);
+        _f = nullptr;
+    }
+    size_t size() {
+        if (!_f) return 0;
+        long pos = ftell(_f);
+        fseek(_f, 0, SEEK_END);
+        long len = ftell(_f);
+        fseek(_f, pos, SEEK_SET);
+        return len;
+    }
+    size_t position() {
+        return _f ? ftell(_f) : 0;
+    }
+    bool seek(uint32_t pos) {
+        return _f && !fseek(_f, pos, SEEK_SET);
+    }
+
+    int available() override {
+        return _f ? size() - position() : 0;
+    }
+    int read() override {
+        return _f ? fgetc(_f) : -1;
+    }
+    int peek() override {
+        if (!_f) return -1;
+        int c = fgetc(_f);
+        if (c >= 0) ungetc(c, _f);
+        return c;
+    }
+    size_t readBytes(char* buffer, size_t length) override {
+        return _f ? fread(buffer, 1, length, _f) : 0;
+    }
+    using Stream::readBytes;
+    size_t write(uint8_t c) override {
+        return _f ? (fputc(c, _f) >= 0) : 0;
+    }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        return _f ? fwrite(buffer, 1, size, _f) : 0;
+    }
+    using Print::write;
+
+   private:
+    FILE* _f;
+};
+
+class FS {
+   public:
+    FS(const char* root = ".") : _root(root) {}
+
+    bool begin() {
+        return true;
+    }
+    File open(const char* path, const char* mode) {
+        String m(mode);
+        if (m.indexOf('b') < 0) m += 'b';
+        return File(fopen(_path(path).c_str(), m.c_str()));
+    }
+    File open(const String& path, const char* mode) {
+        return open(path.c_str(), mode);
+    }
+    bool exists(const char* path) {
+        FILE* f = fopen(_path(path).c_str(), "rb");
+        if (f) fclose(f);
+        return f;
+    }
+    bool exists(const String& path) {
+        return exists(path.c_str());
+    }
+    bool remove(const char* path) {
+        return !::remove(_path(path).c_str());
+    }
+    bool remove(const String& path) {
+        return remove(path.c_str());
+    }
+    // как у LittleFS: существующий файл назначения заменяется
+    bool rename(const char* from, const char* to) {
+        return !::rename(_path(from).c_str(), _path(to).c_str());
+    }
+    bool rename(const String& from, const String& to) {
+        return rename(from.c_str(), to.c_str());
+    }
+
+   private:
+    String _root;
+
+    String _path(const char* path) {
+        return _root + (path[0] == '/' ? "" : "/") + path;
+    }
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
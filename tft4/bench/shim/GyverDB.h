@@ -0,0 +1,41 @@
+#pragma once
+#include <StringUtils.h>
+#include <string.h>
+
+#include <map>
+#include <vector>
+
+// GyverDB в объёме, который использует Kandinsky: двоичные записи по ключу в памяти.
+// Настоящая библиотека хранит указатели в uint32_t и под 64 бита не собирается
+class GyverDB {
+   public:
+    class Entry {
+       public:
+        Entry(const std::vector<uint8_t>* data = nullptr) : _data(data) {}
+
+        template <typename T>
+        bool writeTo(T& dest) const {
+            if (!_data || _data->size() != sizeof(T)) return false;
+            memcpy(&dest, _data->data(), sizeof(T));
+            return true;
+        }
+
+       private:
+        const std::vector<uint8_t>* _data;
+    };
+
+    Entry get(const Text& key) {
+        auto it = _map.find(key.hash());
+        return it == _map.end() ? Entry() : Entry(&it->second);
+    }
+
+    template <typename T>
+    bool set(const Text& key, const T& val) {
+        const uint8_t* p = (const uint8_t*)&val;
+        _map[key.hash()].assign(p, p + sizeof(T));
+        return true;
+    }
+
+   private:
+    std::map<size_t, std::vector<uint8_t>> _map;
+};
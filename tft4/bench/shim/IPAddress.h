@@ -0,0 +1,25 @@
+#pragma once
+#include <stdint.h>
+
+#include "WString.h"
+
+class IPAddress {
+   public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _addr{a, b, c, d} {}
+
+    uint8_t operator[](int index) const {
+        return _addr[index];
+    }
+    String toString() const {
+        String s;
+        for (int i = 0; i < 4; i++) {
+            if (i) s += '.';
+            s += _addr[i];
+        }
+        return s;
+    }
+
+   private:
+    uint8_t _addr[4] = {0, 0, 0, 0};
+};
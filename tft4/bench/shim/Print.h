@@ -0,0 +1,90 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Printable.h"
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print {
+   public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* str) {
+        return str ? write((const uint8_t*)str, strlen(str)) : 0;
+    }
+    size_t write(const char* buffer, size_t size) {
+        return write((const uint8_t*)buffer, size);
+    }
+    virtual int availableForWrite() {
+        return 0;
+    }
+    virtual void flush() {}
+
+    int getWriteError() {
+        return write_error;
+    }
+    void clearWriteError() {
+        write_error = 0;
+    }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    size_t print(const __FlashStringHelper* s) {
+        return write((const char*)s);
+    }
+    size_t print(const String& s) {
+        return write((const uint8_t*)s.c_str(), s.length());
+    }
+    size_t print(const char* s) {
+        return write(s);
+    }
+    size_t print(char c) {
+        return write((uint8_t)c);
+    }
+    size_t print(unsigned char n, int base = DEC) {
+        return print((unsigned long)n, base);
+    }
+    size_t print(int n, int base = DEC) {
+        return print((long)n, base);
+    }
+    size_t print(unsigned int n, int base = DEC) {
+        return print((unsigned long)n, base);
+    }
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(long long n, int base = DEC);
+    size_t print(unsigned long long n, int base = DEC);
+    size_t print(double n, int digits = 2);
+    size_t print(const Printable& p) {
+        return p.printTo(*this);
+    }
+
+    template <typename T>
+    size_t println(const T& v) {
+        size_t n = print(v);
+        return n + println();
+    }
+    template <typename T>
+    size_t println(const T& v, int mod) {
+        size_t n = print(v, mod);
+        return n + println();
+    }
+    size_t println() {
+        return write("\r\n");
+    }
+
+   protected:
+    void setWriteError(int err = 1) {
+        write_error = err;
+    }
+
+   private:
+    int write_error = 0;
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include "Print.h"
+
+// peek buffer API как в ядре ESP8266 3.x
+#define STREAM_PEEK_API
+
+class Stream : public Print {
+   public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) {
+        _timeout = timeout;
+    }
+    unsigned long getTimeout() const {
+        return _timeout;
+    }
+
+    bool find(const char* target);
+    bool find(char target) {
+        return find(&target, 1);
+    }
+    bool find(const char* target, size_t length);
+
+    virtual size_t readBytes(char* buffer, size_t length);
+    size_t readBytes(uint8_t* buffer, size_t length) {
+        return readBytes((char*)buffer, length);
+    }
+    size_t readBytesUntil(char terminator, char* buffer, size_t length);
+    size_t readBytesUntil(char terminator, uint8_t* buffer, size_t length) {
+        return readBytesUntil(terminator, (char*)buffer, length);
+    }
+    virtual String readString();
+    String readStringUntil(char terminator);
+
+    virtual bool hasPeekBufferAPI() const {
+        return false;
+    }
+    virtual size_t peekAvailable() {
+        return 0;
+    }
+    virtual const char* peekBuffer() {
+        return nullptr;
+    }
+    virtual void peekConsume(size_t consume) {
+        (void)consume;
+    }
+
+   protected:
+    unsigned long _timeout = 1000;
+    int timedRead();
+    int timedPeek();
+};
@@ -0,0 +1,223 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pgmspace.h"
+
+// String в объёме, который используют проект и библиотеки Gyver (по мотивам ESP8266 WString)
+
+class __FlashStringHelper;
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper*>(p))
+#define F(s) FPSTR(PSTR(s))
+
+class String {
+   public:
+    String(const char* cstr = "") {
+        if (cstr) copy(cstr, strlen(cstr));
+    }
+    String(const char* cstr, size_t len) {
+        if (cstr) copy(cstr, len);
+    }
+    String(const String& str) {
+        copy(str.buffer(), str.len);
+    }
+    String(String&& rval) noexcept {
+        move(rval);
+    }
+    String(const __FlashStringHelper* str) : String((const char*)str) {}
+    explicit String(char c) {
+        copy(&c, 1);
+    }
+    explicit String(unsigned char v, unsigned char base = 10);
+    explicit String(int v, unsigned char base = 10);
+    explicit String(unsigned int v, unsigned char base = 10);
+    explicit String(long v, unsigned char base = 10);
+    explicit String(unsigned long v, unsigned char base = 10);
+    explicit String(long long v, unsigned char base = 10);
+    explicit String(unsigned long long v, unsigned char base = 10);
+    explicit String(float v, unsigned char decimalPlaces = 2);
+    explicit String(double v, unsigned char decimalPlaces = 2);
+    ~String() {
+        free(buf);
+    }
+
+    String& operator=(const String& rhs) {
+        if (this != &rhs) copy(rhs.buffer(), rhs.len);
+        return *this;
+    }
+    String& operator=(String&& rval) noexcept {
+        if (this != &rval) {
+            free(buf);
+            move(rval);
+        }
+        return *this;
+    }
+    String& operator=(const char* cstr) {
+        if (cstr) copy(cstr, strlen(cstr));
+        else invalidate();
+        return *this;
+    }
+    String& operator=(const __FlashStringHelper* str) {
+        return *this = (const char*)str;
+    }
+    String& operator=(char c) {
+        copy(&c, 1);
+        return *this;
+    }
+
+    bool reserve(size_t size);
+    unsigned int length() const {
+        return len;
+    }
+    bool isEmpty() const {
+        return !len;
+    }
+
+    bool concat(const String& str) {
+        return concat(str.buffer(), str.len);
+    }
+    bool concat(const char* cstr, size_t length);
+    bool concat(const char* cstr) {
+        return cstr ? concat(cstr, strlen(cstr)) : false;
+    }
+    bool concat(const __FlashStringHelper* str) {
+        return concat((const char*)str);
+    }
+    bool concat(char c) {
+        return concat(&c, 1);
+    }
+    bool concat(unsigned char v);
+    bool concat(int v);
+    bool concat(unsigned int v);
+    bool concat(long v);
+    bool concat(unsigned long v);
+    bool concat(long long v);
+    bool concat(unsigned long long v);
+    bool concat(float v);
+    bool concat(double v);
+
+    template <typename T>
+    String& operator+=(const T& rhs) {
+        concat(rhs);
+        return *this;
+    }
+    String& operator+=(const char* cstr) {
+        concat(cstr);
+        return *this;
+    }
+
+    friend String operator+(const String& lhs, const String& rhs) {
+        String s(lhs);
+        s += rhs;
+        return s;
+    }
+    friend String operator+(const String& lhs, const char* rhs) {
+        String s(lhs);
+        s += rhs;
+        return s;
+    }
+    friend String operator+(const char* lhs, const String& rhs) {
+        String s(lhs);
+        s += rhs;
+        return s;
+    }
+    friend String operator+(String&& lhs, const String& rhs) {
+        lhs += rhs;
+        return static_cast<String&&>(lhs);
+    }
+    friend String operator+(String&& lhs, const char* rhs) {
+        lhs += rhs;
+        return static_cast<String&&>(lhs);
+    }
+    friend String operator+(String&& lhs, char rhs) {
+        lhs += rhs;
+        return static_cast<String&&>(lhs);
+    }
+
+    explicit operator bool() const {
+        return buf != nullptr;
+    }
+    int compareTo(const String& s) const;
+    bool equals(const String& s) const {
+        return len == s.len && compareTo(s) == 0;
+    }
+    bool equals(const char* cstr) const;
+    bool operator==(const String& rhs) const {
+        return equals(rhs);
+    }
+    bool operator==(const char* cstr) const {
+        return equals(cstr);
+    }
+    bool operator!=(const String& rhs) const {
+        return !equals(rhs);
+    }
+    bool operator!=(const char* cstr) const {
+        return !equals(cstr);
+    }
+    bool equalsIgnoreCase(const String& s) const;
+    bool startsWith(const String& prefix) const;
+    bool endsWith(const String& suffix) const;
+
+    char charAt(unsigned int index) const {
+        return operator[](index);
+    }
+    void setCharAt(unsigned int index, char c) {
+        if (index < len) buf[index] = c;
+    }
+    char operator[](unsigned int index) const {
+        return index < len ? buf[index] : 0;
+    }
+    char& operator[](unsigned int index);
+    void toCharArray(char* out, unsigned int bufsize, unsigned int index = 0) const;
+    const char* c_str() const {
+        return buffer();
+    }
+    char* begin() {
+        return wbuffer();
+    }
+    char* end() {
+        return wbuffer() + len;
+    }
+    const char* begin() const {
+        return c_str();
+    }
+    const char* end() const {
+        return c_str() + len;
+    }
+
+    int indexOf(char ch, unsigned int fromIndex = 0) const;
+    int indexOf(const String& str, unsigned int fromIndex = 0) const;
+    int lastIndexOf(char ch) const;
+    String substring(unsigned int beginIndex) const {
+        return substring(beginIndex, len);
+    }
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+    void replace(char find, char replace);
+    void remove(unsigned int index, unsigned int count = (unsigned int)-1);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long toInt() const;
+    float toFloat() const;
+    double toDouble() const;
+
+   protected:
+    char* buf = nullptr;
+    size_t len = 0;
+    size_t cap = 0;
+
+    const char* buffer() const {
+        return buf ? buf : "";
+    }
+    char* wbuffer() {
+        return buf ? buf : (char*)"";
+    }
+    void invalidate();
+    String& copy(const char* cstr, size_t length);
+    void move(String& rhs) noexcept;
+    bool _concatNumber(const char* str);
+};
@@ -0,0 +1,8 @@
+#pragma once
+#include "WiFi.h"
+
+class WiFiClientSecure : public WiFiClient {
+   public:
+    void setInsecure() {}
+    void setBufferSizes(int, int) {}
+};
@@ -0,0 +1,24 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+// на хосте PROGMEM - обычная память
+
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_ptr(addr) (*(void* const*)(addr))
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strstr_P strstr
+#define memcpy_P memcpy
+#define memcmp_P memcmp
+#define strchr_P strchr
+#define strcasecmp_P strcasecmp
+#define strncasecmp_P strncasecmp
@@ -0,0 +1,22 @@
+#pragma once
+// нестандартные функции stdlib из ядра ESP8266
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+char* itoa(int val, char* s, int radix);
+char* ltoa(long val, char* s, int radix);
+char* utoa(unsigned int val, char* s, int radix);
+char* ultoa(unsigned long val, char* s, int radix);
+char* dtostrf(double number, signed char width, unsigned char prec, char* s);
+
+// strlcpy есть в newlib, в glibc - только с 2.38
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+#define SHIM_STRLCPY
+size_t strlcpy(char* dst, const char* src, size_t size);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
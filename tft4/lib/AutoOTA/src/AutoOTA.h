@@ -1,5 +1,6 @@
 #pragma once
 #include <Arduino.h>
+#include <GSON.h>
 
 #if defined(ESP8266)
 #include <ESP8266WiFi.h>
@@ -187,36 +188,61 @@ class AutoOTA {
         client.setInsecure();
         if (!_request(client, _host, _path, _port)) return false;
 
-        if (version) *version = _readKey(client, "version");
-        if (notes) *notes = _readKey(client, "notes");
-        if (bin) {
-            String chip;
-
-            while (true) {
-                delay(0);
-                chip = _readKey(client, "chipFamily");
-                if (!chip.length()) return _err = Error::NoPlatform, false;
-
-                if (chip != GOTA_PLATFORM) continue;
+        // project.json разбирается потоком: version, notes и path из builds с нашим chipFamily.
+        // path внутри объекта сборки может идти раньше chipFamily, поэтому запоминается до конца объекта.
+        // Документ читается до конца: version может идти после builds
+        if (bin) *bin = "";
+        gson::StreamParser json(&client);
+        uint8_t build = 0;  // вложенность объектов сборки, 0 - вне builds
+        bool chip = false, found = false;
+        String path;
+        while (true) {
+            delay(0);
+            gson::StreamParser::Event e = json.next();
+            if (e == gson::StreamParser::Event::None) break;
 
-                *bin = _readKey(client, "path");
-                if (!bin->length()) return _err = Error::NoPath, false;
-                break;
+            if (e == gson::StreamParser::Event::Array) {
+                if (json.key() == "builds") build = json.depth() + 1;
+                continue;
+            }
+            if (e == gson::StreamParser::Event::Object) {
+                if (build && json.depth() == build) chip = false, path = "";
+                continue;
+            }
+            if (e == gson::StreamParser::Event::End) {
+                if (json.depth() < build) build = 0;
+                else if (json.depth() == build && chip && bin && !bin->length()) *bin = path;
+                continue;
+            }
+            if (!json.is(gson::Type::String)) continue;
+
+            switch (json.key().hash()) {
+                case SH("version"):
+                    if (version) *version = _readString(json.string());
+                    break;
+                case SH("notes"):
+                    if (notes) *notes = _readString(json.string());
+                    break;
+                case SH("chipFamily"):
+                    if (build) chip = json.value() == GOTA_PLATFORM;
+                    if (chip) found = true;
+                    break;
+                case SH("path"):
+                    if (bin && build && !path.length()) path = _readString(json.string());
+                    break;
             }
         }
+        if (bin && !bin->length()) return _err = found ? Error::NoPath : Error::NoPlatform, false;
         return true;
     }
 
-    String _readKey(Stream& stream, const String& key) {
-        while (stream.available()) {
-            stream.readStringUntil('"');
-            String thisKey = stream.readStringUntil('"');
-            if (thisKey == key) {
-                stream.readStringUntil('"');
-                return stream.readStringUntil('"');
-            }
-        }
-        return String();
+    // строковое значение целиком, без ограничения буфера парсера
+    static String _readString(Stream& stream) {
+        String str;
+        char buf[32];
+        size_t len;
+        while ((len = stream.readBytes(buf, sizeof(buf)))) str.concat(buf, len);
+        return str;
     }
 
     bool _waitClient(OtaClient& client) {
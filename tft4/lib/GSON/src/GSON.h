@@ -1,6 +1,7 @@
 #pragma once
 
 #include "utils/parser.h"
+#include "utils/parser_sax.h"
 #include "utils/parser_stream.h"
 #include "utils/str.h"
 #include "utils/string.h"
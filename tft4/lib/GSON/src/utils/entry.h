@@ -23,10 +23,8 @@ class Entry : public Text {
     // получить элемент по ключу
     Entry get(const Text& key) const {
         if (_valid() && ens->_get(idx).isObject()) {
-            for (uint16_t i = idx + 1; i < ens->length(); i++) {
-                if (ens->_get(i).parent == idx &&
-                    ens->_get(i).key_offs &&
-                    key.compare(ens->keyText(i))) return Entry(ens, i);
+            for (uint16_t i = idx + 1, end = _end(); i < end; i = _next(i)) {
+                if (ens->_get(i).key_offs && key.compare(ens->keyText(i))) return Entry(ens, i);
             }
         }
         return Entry();
@@ -56,8 +54,8 @@ class Entry : public Text {
     // получить элемент по хэшу ключа
     Entry get(size_t hash) const {
         if (_valid() && ens->hashed() && ens->_get(idx).isObject()) {
-            for (uint16_t i = idx + 1; i < ens->length(); i++) {
-                if (ens->_get(i).parent == idx && ens->hash[i] == hash) return Entry(ens, i);
+            for (uint16_t i = idx + 1, end = _end(); i < end; i = _next(i)) {
+                if (ens->hash[i] == hash) return Entry(ens, i);
             }
         }
         return Entry();
@@ -78,11 +76,9 @@ class Entry : public Text {
     // получить элемент по индексу
     Entry get(int index) const {
         if (_valid() && (size_t)index < ens->length() && ens->_get(idx).isContainer()) {
-            for (uint16_t i = idx + 1; i < ens->length(); i++) {
-                if (ens->_get(i).parent == idx) {
-                    if (!index) return Entry(ens, i);
-                    --index;
-                }
+            for (uint16_t i = idx + 1, end = _end(); i < end; i = _next(i)) {
+                if (!index) return Entry(ens, i);
+                --index;
             }
         }
         return Entry();
@@ -91,9 +87,7 @@ class Entry : public Text {
     // итерация по вложенным
     void loop(void (*cb)(Entry e)) {
         if (_valid() && ens->_get(idx).isContainer()) {
-            for (uint16_t i = idx + 1; i < ens->length(); i++) {
-                if (ens->_get(i).parent == idx) cb(Entry(ens, i));
-            }
+            for (uint16_t i = idx + 1, end = _end(); i < end; i = _next(i)) cb(Entry(ens, i));
         }
     }
 
@@ -107,6 +101,7 @@ class Entry : public Text {
     // декодировать UCN (unicode) в записи
     void decodeUCN() {
         gsutil::Entry_t& e = ens->_get(idx);
+        if (e.isContainer()) return;
         e.val_len = su::unicode::decodeSelf((char*)e.value(ens->str), e.val_len);
     }
 
@@ -133,9 +128,7 @@ class Entry : public Text {
     size_t length() const {
         if (!_valid() || !ens->_get(idx).isContainer()) return 0;
         size_t len = 0;
-        for (size_t i = 0; i < ens->length(); i++) {
-            if (ens->_get(i).parent == idx) len++;
-        }
+        for (uint16_t i = idx + 1, end = _end(); i < end; i = _next(i)) len++;
         return len;
     }
 
@@ -184,9 +177,8 @@ class Entry : public Text {
     template <typename T>
     bool parseTo(T& arr) const {
         if (!isArray()) return false;
-        for (size_t i = 0; i < length(); i++) {
-            arr[i] = ens->valueText(idx + 1 + i);
-        }
+        size_t n = 0;
+        for (uint16_t i = idx + 1, end = _end(); i < end; i = _next(i)) arr[n++] = ens->valueText(i);
         return true;
     }
 
@@ -221,6 +213,16 @@ class Entry : public Text {
         return ens && ens->valid();
     }
 
+    // конец поддерева контейнера
+    uint16_t _end() const {
+        return idx + 1 + ens->_get(idx).subtree();
+    }
+
+    // следующий сосед элемента i
+    uint16_t _next(uint16_t i) const {
+        return i + 1 + ens->_get(i).subtree();
+    }
+
     void _printTab(Print& p, uint8_t amount) const {
         while (amount--) {
             p.print(' ');
@@ -47,6 +47,8 @@ struct Entry_t {
     uint16_t val_len : 15;                    // 32 768
 #endif                      // GSON_NO_LIMITS
 
+    // у контейнера нет значения: val_len хранит размер поддерева (количество вложенных всех уровней).
+    // Первый вложенный идёт сразу за контейнером, следующий сосед - сразу за поддеревом
     uint16_t key_offs;
     uint16_t val_offs;
 
@@ -66,7 +68,12 @@ struct Entry_t {
         return Text(key(json), key_len);
     }
     inline Text valueText(const char* json) const {
-        return Text(value(json), val_len);
+        return Text(value(json), isContainer() ? 0 : val_len);
+    }
+
+    // размер поддерева контейнера
+    inline uint16_t subtree() const {
+        return isContainer() ? val_len : 0;
     }
 
     inline bool is(gson::Type t) const {
@@ -4,8 +4,14 @@
 
 #include "entry.h"
 #include "entry_stack.h"
+#include "scan.h"
 #include "types.h"
 
+// максимум путей в фильтре parse(json, filter)
+#ifndef GSON_FILTER_PATHS
+#define GSON_FILTER_PATHS 8
+#endif
+
 namespace gson {
 
 // ================== PARSER ==================
@@ -196,6 +202,20 @@ class Parser {
         return _startParse((const char*)json, len);
     }
 
+    // парсить только элементы по путям фильтра через запятую, например "uuid,result.files[0]".
+    // Путь: ключи через точку, индекс массива [n], любой ключ * или индекс [*], корень - начало пути.
+    // Остальные значения пропускаются без записи, контейнеры на пути к нужным сохраняются.
+    // Индексы в массивах после парсинга - среди сохранённых элементов
+    bool parse(const Text& json, const Text& filter) {
+        return json.pgm() ? 0 : _startParse(json.str(), json.length(), filter);
+    }
+    bool parse(const char* json, uint16_t len, const Text& filter) {
+        return _startParse(json, len, filter);
+    }
+    bool parse(const uint8_t* json, uint16_t len, const Text& filter) {
+        return _startParse((const char*)json, len, filter);
+    }
+
     // вывести в Print с форматированием
     void stringify(Print& pr) const {
         if (length()) Entry(&ents, 0).stringify(pr);
@@ -232,8 +252,14 @@ class Parser {
     gsutil::Entry_t ebuf;
     uint8_t depth = 16;
     const char* endp = 0;
-
-    bool _startParse(const char* json, size_t length) {
+    const char* filt = nullptr;
+    uint8_t filt_len = 0;
+    uint8_t filt_n = 0;
+#ifdef GSON_SCAN
+    gsutil::Scanner scan;
+#endif
+
+    bool _startParse(const char* json, size_t length, const Text& filter = Text()) {
         if (!length) {
             error = Error::EmptyString;
             return 0;
@@ -251,9 +277,37 @@ class Parser {
         ebuf = gsutil::Entry_t();
         ents.clear();
 
+        // начало каждого пути фильтра
+        uint8_t fpos[GSON_FILTER_PATHS];
+        filt = nullptr;
+        filt_n = 0;
+        if (filter.length()) {
+            if (filter.pgm() || filter.length() >= _FILT_DEAD) {
+                error = Error::Filter;
+                return 0;
+            }
+            filt = filter.str();
+            filt_len = filter.length();
+            fpos[filt_n++] = 0;
+            for (uint8_t i = 0; i < filt_len; i++) {
+                if (filt[i] != ',') continue;
+                if (filt_n == GSON_FILTER_PATHS) {
+                    error = Error::Filter;
+                    return 0;
+                }
+                fpos[filt_n++] = i + 1;
+            }
+        }
+
         if ((strp[0] == '{' && strp[length - 1] == '}') || (strp[0] == '[' && strp[length - 1] == ']')) {
-            ents.reserve(_count(json, length));
-            error = _parse(0);
+            // с фильтром записей заметно меньше оценки - буфер растёт по мере надобности
+#ifdef GSON_SCAN
+            scan.begin(json, endp);
+            if (!filt) ents.reserve(gsutil::Scanner::count(json, endp));
+#else
+            if (!filt) ents.reserve(_count(json, length));
+#endif
+            error = _parse(0, filt ? fpos : nullptr);
             ents[0].parent = GSON_MAX_INDEX;
         } else {
             error = Error::NotContainer;
@@ -261,7 +315,12 @@ class Parser {
         return !hasError();
     }
 
-    Error _parse(parent_t parent) {
+    // fpos - позиции путей фильтра для элементов parent, nullptr - нужны все
+    Error _parse(parent_t parent, const uint8_t* fpos) {
+        uint8_t cpos[GSON_FILTER_PATHS];  // позиции для вложенных в текущий элемент
+        const uint8_t* next = nullptr;
+        uint16_t index = 0;  // индекс текущего элемента в parent
+
         while (strp && strp < endp && *strp) {
             switch (*strp) {
                 case ' ':
@@ -333,6 +392,15 @@ class Parser {
                             return Error::UnexOpen;
                         }
                     }
+                    if (strp == ents.str) {
+                        next = fpos;  // корень
+                    } else if (!_pass(fpos, cpos, next, parent, index++, true)) {
+                        error = _skip();
+                        if (hasError()) return error;
+                        ebuf.reset();
+                        state = State::Idle;
+                        break;
+                    }
                     if (length() == GSON_MAX_INDEX - 1) return Error::IndexOverflow;
 
                     ebuf.type = (*strp == '{') ? Type::Object : Type::Array;
@@ -345,9 +413,11 @@ class Parser {
                     if (depth - 1 == 0) return Error::TooDeep;
 
                     --depth;
-                    error = _parse(length() - 1);  // RECURSIVE
+                    parent_t cont = length() - 1;
+                    error = _parse(cont, next);  // RECURSIVE
                     ++depth;
                     if (hasError()) return error;
+                    ents[cont].val_len = length() - 1 - cont;
                 } break;
 
                 case '}':
@@ -415,9 +485,11 @@ class Parser {
                             return Error::BrokenToken;
                         }
                     }
-                    if (length() == GSON_MAX_INDEX - 1) return Error::IndexOverflow;
-                    ebuf.parent = parent;
-                    if (!ents.push(ebuf)) return Error::Alloc;
+                    if (_pass(fpos, cpos, next, parent, index++, false)) {
+                        if (length() == GSON_MAX_INDEX - 1) return Error::IndexOverflow;
+                        ebuf.parent = parent;
+                        if (!ents.push(ebuf)) return Error::Alloc;
+                    }
                     ebuf.reset();
                     state = State::Idle;
                 } break;
@@ -436,21 +508,104 @@ class Parser {
                         if (strp[-1] != '\\') break;
                     }
                 }
-                if (length() == GSON_MAX_INDEX - 1) return Error::IndexOverflow;
-                ebuf.val_len = strp - ebuf.value(ents.str);
-                ebuf.parent = parent;
-                ebuf.type = Type::String;
-                if (!ents.push(ebuf)) return Error::Alloc;
+                if (_pass(fpos, cpos, next, parent, index++, false)) {
+                    if (length() == GSON_MAX_INDEX - 1) return Error::IndexOverflow;
+                    ebuf.val_len = strp - ebuf.value(ents.str);
+                    ebuf.parent = parent;
+                    ebuf.type = Type::String;
+                    if (!ents.push(ebuf)) return Error::Alloc;
+                }
                 ebuf.reset();
                 state = State::Idle;
             }
 
+#ifdef GSON_SCAN
+            if (strp) strp = (char*)scan.next(strp);  // пробелы и середина токенов пропускаются
+#else
             if (strp) ++strp;
+#endif
         }  // while
 
         return (parent == 0) ? Error::None : Error::BrokenContainer;
     }
 
+    // ============ FILTER ============
+    enum : uint8_t {
+        _FILT_DEAD = 0xff,  // путь не совпал
+    };
+
+    // нужен ли элемент parent с ключом в ebuf или индексом index. cont - элемент контейнер,
+    // ему достаточно совпасть с началом пути. next - позиции путей для его вложенных (nullptr - нужны все)
+    bool _pass(const uint8_t* fpos, uint8_t* cpos, const uint8_t*& next, parent_t parent, uint16_t index, bool cont) {
+        next = nullptr;
+        if (!fpos) return true;
+        bool pass = false, full = false, arr = ents[parent].isArray();
+        for (uint8_t i = 0; i < filt_n; i++) {
+            cpos[i] = _step(fpos[i], arr, index);
+            if (cpos[i] == _FILT_DEAD) continue;
+            pass = true;
+            if (_pathEnd(cpos[i])) full = true;
+        }
+        if (full) return true;
+        if (pass && cont) next = cpos;
+        return pass && cont;
+    }
+
+    // пройти по пути один уровень
+    uint8_t _step(uint8_t p, bool arr, uint16_t index) {
+        if (p == _FILT_DEAD || _pathEnd(p)) return p;
+        if (filt[p] == '.') ++p;
+        if (arr) {
+            if (p >= filt_len || filt[p] != '[') return (uint8_t)_FILT_DEAD;
+            ++p;
+            if (p < filt_len && filt[p] == '*') {
+                ++p;
+            } else {
+                uint8_t s = p;
+                uint16_t n = 0;
+                while (p < filt_len && filt[p] >= '0' && filt[p] <= '9') n = n * 10 + (filt[p++] - '0');
+                if (p == s || n != index) return (uint8_t)_FILT_DEAD;
+            }
+            if (p >= filt_len || filt[p] != ']') return (uint8_t)_FILT_DEAD;
+            return p + 1;
+        }
+        uint8_t s = p;
+        while (p < filt_len && filt[p] != '.' && filt[p] != '[' && filt[p] != ',') ++p;
+        if (p - s == 1 && filt[s] == '*') return p;
+        return Text(filt + s, p - s).compare(ebuf.keyText(ents.str)) ? p : (uint8_t)_FILT_DEAD;
+    }
+
+    bool _pathEnd(uint8_t p) const {
+        return p >= filt_len || filt[p] == ',';
+    }
+
+    // пропустить контейнер без записи, strp останется на закрывающей скобке
+    Error _skip() {
+        uint16_t lvl = 0;
+        for (; strp < endp; strp++) {
+            switch (*strp) {
+                case '\"':
+                    while (1) {
+                        strp = (char*)memchr((void*)(strp + 1), '\"', endp - strp - 1);
+                        if (!strp) return Error::BrokenString;
+                        if (strp[-1] != '\\') break;
+                    }
+                    break;
+
+                case '{':
+                case '[':
+                    ++lvl;
+                    break;
+
+                case '}':
+                case ']':
+                    if (!--lvl) return Error::None;
+                    break;
+            }
+        }
+        return Error::BrokenContainer;
+    }
+
     // посчитать приблизительное количество элементов
     uint16_t _count(const char* str, uint16_t len) {
         if (!len) return 0;
@@ -0,0 +1,631 @@
+#pragma once
+#include <Arduino.h>
+#include <StringUtils.h>
+
+#include "entry_t.h"
+#include "types.h"
+
+// максимальная вложенность контейнеров (не больше 31)
+#ifndef GSON_STREAM_DEPTH
+#define GSON_STREAM_DEPTH 16
+#endif
+
+// буфер значения: числа, bool, null и строки через value() (длиннее - обрезаются)
+#ifndef GSON_STREAM_VAL_LEN
+#define GSON_STREAM_VAL_LEN 64
+#endif
+
+// буфер чтения из потока с запасом (не больше 255)
+#ifndef GSON_STREAM_BUF
+#define GSON_STREAM_BUF 64
+#endif
+
+#if defined(ESP8266) || defined(STREAM_PEEK_API)
+#define GSON_PEEK_API
+#endif
+
+namespace gson {
+
+// ================== STREAM PARSER ==================
+// Потоковый (SAX) парсер: читает JSON из Stream блоками через свой буфер GSON_STREAM_BUF и выдаёт события next(),
+// документ целиком не хранится. Память - буферы чтения, ключа и значения фиксированного размера.
+// Из потока читается то, что уже пришло, поэтому после разбора он может стоять дальше конца документа.
+// Строковое значение не читается до вызова value() или string(): через string() его можно
+// отдать дальше как поток (например, base64 картинки в декодер), не загружая в память
+class StreamParser {
+   public:
+    enum class Event : uint8_t {
+        None,    // документ закончился или ошибка (hasError())
+        Object,  // начало объекта
+        Array,   // начало массива
+        End,     // конец объекта или массива
+        Value,   // значение, тип - type()
+        More,    // событие пришло не целиком (setWait(false)): вызвать next() позже, разбор продолжится с того же места
+    };
+
+    StreamParser(Stream* stream = nullptr) : _sub(*this) {
+        if (stream) begin(*stream);
+    }
+
+    // начать разбор документа из потока
+    void begin(Stream& stream) {
+        _s = &stream;
+        _err = Error::None;
+        _bpos = _blen = _mark = 0;
+        _nodata = false;
+        _depth = _edepth = 0;
+        _index = 0;
+        _arr = 0;
+        _wantKey = _pending = _done = false;
+        _key_len = _val_len = 0;
+        _key[0] = _val[0] = 0;
+        _type = Type::None;
+        _sub._reset();
+    }
+
+    // ждать данные потока в next() (по умолчанию). Без ожидания next() вернёт Event::More, если событие ещё не пришло
+    // целиком, а строковое значение отдаст, когда оно пришло до кавычки - value() его уже не ждёт (строка длиннее
+    // GSON_STREAM_BUF отдаётся сразу). Пришедшее - по peekAvailable() у потоков с peek API, иначе по available().
+    // string() тогда читает только пришедшее, skip() ждёт всегда
+    void setWait(bool wait) {
+        _wait = wait;
+    }
+
+    // следующее событие
+    Event next() {
+        if (!_s || _done || hasError()) return Event::None;
+        _nb = !_wait;
+        _nodata = false;
+        Event e = _next();
+        _nb = false;
+        return e;
+    }
+
+    // пропустить содержимое контейнера после события Object или Array (до его End включительно)
+    bool skip() {
+        uint8_t depth = _depth;
+        if (!depth) return false;
+        bool wait = _wait;
+        bool ok = false;
+        _wait = true;
+        while (true) {
+            Event e = next();
+            if (e == Event::None) break;
+            if (e == Event::End && _depth < depth) {
+                ok = true;
+                break;
+            }
+        }
+        _wait = wait;
+        return ok;
+    }
+
+    // ключ текущего элемента (пустой в массиве)
+    Text key() const {
+        return Text(_key, _key_len);
+    }
+
+    // тип текущего элемента
+    Type type() const {
+        return _type;
+    }
+    bool is(Type type) const {
+        return _type == type;
+    }
+
+    // вложенность текущего элемента: 0 - корневой контейнер
+    uint8_t depth() const {
+        return _edepth;
+    }
+
+    // индекс текущего элемента в родительском контейнере
+    uint16_t index() const {
+        return _index;
+    }
+
+    // родитель текущего элемента - массив
+    bool inArray() const {
+        return _edepth && _isArray(_edepth);
+    }
+
+    // значение. Строка читается при первом вызове в буфер GSON_STREAM_VAL_LEN, остаток пропускается
+    Text value() {
+        if (_pending) {
+            _val_len = _sub.readBytes(_val, GSON_STREAM_VAL_LEN);
+            _val[_val_len] = 0;
+            if (!_skipString()) _err = Error::BrokenString;
+        }
+        return Text(_val, _val_len);
+    }
+
+    // строковое значение потоком с раскрытым экранированием, до закрывающей кавычки.
+    // Не прочитанное до следующего next() пропускается
+    Stream& string() {
+        return _sub;
+    }
+
+    // ============ ERROR ============
+    bool hasError() const {
+        return _err != Error::None;
+    }
+    Error getError() const {
+        return _err;
+    }
+    const __FlashStringHelper* readError() const {
+        return gson::readError(_err);
+    }
+
+   private:
+    // ================== STRING STREAM ==================
+    class StringStream : public Stream {
+        friend class StreamParser;
+
+       public:
+        StringStream(StreamParser& p) : p(p) {}
+
+        // пришло символов строки (вместе с закрывающей кавычкой и тем, что за ней)
+        int available() override {
+            if (_ucn_len) return _ucn_len;
+            if (!p._pending) return 0;
+            return (p._blen - p._bpos) + p._arrived();
+        }
+        int read() override {
+            return _ready() ? _char() : -1;
+        }
+        int peek() override {
+            return -1;
+        }
+        size_t write(uint8_t) override {
+            return 0;
+        }
+        using Print::write;
+
+        size_t readBytes(char* buf, size_t len) override {
+            size_t n = 0;
+            while (n < len) {
+                size_t run = _run();
+                if (run) {
+                    run = min(run, len - n);
+                    memcpy(buf + n, _runBuf(), run);
+                    _consume(run);
+                    n += run;
+                    continue;
+                }
+                if (!_ready()) break;
+                // закрывающая кавычка - отдельным пустым чтением: короткое чтение без ожидания - ещё не конец строки
+                if (n && p._pending && !_ucn_len && p._bpos < p._blen && p._buf[p._bpos] == '\"') break;
+                int c = _char();
+                if (c < 0) break;
+                buf[n++] = c;
+            }
+            _nopeek = false;
+            return n;
+        }
+        using Stream::readBytes;
+
+#ifdef GSON_PEEK_API
+        // буфер источника отдаётся, пока в нём нет кавычки и экранирования.
+        // На них буфер выключается до следующего readBytes() - получатель читает копией
+        bool hasPeekBufferAPI() const override {
+            return !_nopeek && p._pending && !_ucn_len && p._s->hasPeekBufferAPI();
+        }
+        size_t peekAvailable() override {
+            size_t run = _run();
+            if (!run && p._pending && (p._bpos < p._blen || p._s->peekAvailable())) _nopeek = true;
+            return run;
+        }
+        const char* peekBuffer() override {
+            return _runBuf();
+        }
+        void peekConsume(size_t consume) override {
+            _consume(consume);
+        }
+#endif
+
+       private:
+        StreamParser& p;
+        uint8_t _ucn[3];
+        uint8_t _ucn_len = 0;
+        bool _nopeek = false;
+
+        void _reset() {
+            _ucn_len = 0;
+            _nopeek = false;
+        }
+
+        // длина куска строки без кавычек и экранирования, который можно отдать одним блоком:
+        // из буфера парсера, а когда он пуст - из буфера источника
+        size_t _run() {
+            if (!p._pending || _ucn_len) return 0;
+            size_t av;
+            if (p._bpos < p._blen) {
+                av = p._blen - p._bpos;
+            } else {
+#ifdef GSON_PEEK_API
+                if (!p._s->hasPeekBufferAPI()) return 0;
+                av = p._s->peekAvailable();
+                if (!av) return 0;
+#else
+                return 0;
+#endif
+            }
+            const char* b = _runBuf();
+            const char* q = (const char*)memchr(b, '\"', av);
+            if (q) av = q - b;
+            const char* e = (const char*)memchr(b, '\\', av);
+            return e ? e - b : av;
+        }
+        const char* _runBuf() {
+#ifdef GSON_PEEK_API
+            if (p._bpos >= p._blen) return p._s->peekBuffer();
+#endif
+            return (const char*)p._buf + p._bpos;
+        }
+        void _consume(size_t n) {
+#ifdef GSON_PEEK_API
+            if (p._bpos >= p._blen) return p._s->peekConsume(n);
+#endif
+            p._bpos += n;
+        }
+
+        // без ожидания (setWait(false)): следующий символ пришёл в буфер парсера целиком, вместе с экранированием
+        bool _ready() {
+            if (p._wait || _ucn_len || !p._pending) return true;
+            uint8_t need = 1;
+            while (true) {
+                if (p._blen - p._bpos < need) {
+                    if (p._arrived() <= 0 || !p._fill()) return false;
+                    continue;
+                }
+                // \x - 2 символа, \uXXXX - 6, старший суррогат \uD800..\uDBFF ждёт пару - 12
+                const uint8_t* b = p._buf + p._bpos;
+                uint8_t d = b[need == 6 ? 3 : 0] | 0x20;
+                if (need == 1 && b[0] == '\\') need = 2;
+                else if (need == 2 && b[1] == 'u') need = 6;
+                else if (need == 6 && (b[2] | 0x20) == 'd' && (d == '8' || d == '9' || d == 'a' || d == 'b')) need = 12;
+                else return true;
+            }
+        }
+
+        // следующий символ строки, -1 - строка кончилась
+        int _char() {
+            if (_ucn_len) {
+                int c = _ucn[0];
+                _ucn[0] = _ucn[1];
+                _ucn[1] = _ucn[2];
+                _ucn_len--;
+                return c;
+            }
+            if (!p._pending) return -1;
+            int c = p._get();
+            if (c == '\"') {
+                p._pending = false;
+                return -1;
+            }
+            if (c == '\\') {
+                c = p._get();
+                switch (c) {
+                    case 'n': c = '\n'; break;
+                    case 'r': c = '\r'; break;
+                    case 't': c = '\t'; break;
+                    case 'b': c = '\b'; break;
+                    case 'f': c = '\f'; break;
+                    case 'u': c = _unicode(); break;
+                    default: break;  // \" \\ \/
+                }
+            }
+            if (c < 0 && !p._nodata) {
+                p._pending = false;
+                p._err = Error::BrokenString;
+            }
+            return c;
+        }
+
+        // \uXXXX в UTF-8: первый байт возвращается, остальные ждут в _ucn.
+        // Пара суррогатов \uD8xx\uDCxx - один символ из 4 байт, одиночный суррогат - U+FFFD
+        int _unicode() {
+            if (!p._ahead(4)) return -1;
+            int32_t u = _hex(p._buf + p._bpos);
+            if (u < 0) return -1;
+            p._bpos += 4;
+            if (u >= 0xD800 && u < 0xE000) {
+                int32_t lo = -1;
+                if (u < 0xDC00 && p._ahead(6) && p._buf[p._bpos] == '\\' && p._buf[p._bpos + 1] == 'u') lo = _hex(p._buf + p._bpos + 2);
+                if (p._nodata) return -1;
+                if (lo >= 0xDC00 && lo < 0xE000) {
+                    p._bpos += 6;
+                    u = 0x10000 + ((u - 0xD800) << 10) + (lo - 0xDC00);
+                } else {
+                    u = 0xFFFD;
+                }
+            }
+            if (u < 0x80) return u;
+            if (u < 0x800) {
+                _ucn[0] = 0x80 | (u & 0x3f);
+                _ucn_len = 1;
+                return 0xc0 | (u >> 6);
+            }
+            if (u < 0x10000) {
+                _ucn[0] = 0x80 | ((u >> 6) & 0x3f);
+                _ucn[1] = 0x80 | (u & 0x3f);
+                _ucn_len = 2;
+                return 0xe0 | (u >> 12);
+            }
+            _ucn[0] = 0x80 | ((u >> 12) & 0x3f);
+            _ucn[1] = 0x80 | ((u >> 6) & 0x3f);
+            _ucn[2] = 0x80 | (u & 0x3f);
+            _ucn_len = 3;
+            return 0xf0 | (u >> 18);
+        }
+
+        // 4 шестнадцатеричные цифры, -1 - не цифра
+        static int32_t _hex(const uint8_t* s) {
+            int32_t u = 0;
+            for (uint8_t i = 0; i < 4; i++) {
+                uint8_t c = s[i];
+                u <<= 4;
+                if (c >= '0' && c <= '9') u |= c - '0';
+                else if (c >= 'a' && c <= 'f') u |= c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') u |= c - 'A' + 10;
+                else return -1;
+            }
+            return u;
+        }
+    };
+
+    Stream* _s = nullptr;
+    StringStream _sub;
+    uint32_t _arr = 0;  // биты уровней вложенности: 1 - массив
+    uint16_t _idx[GSON_STREAM_DEPTH + 1];
+    uint16_t _index = 0;
+    uint8_t _buf[GSON_STREAM_BUF];
+    uint8_t _bpos = 0;  // следующий символ в буфере
+    uint8_t _blen = 0;
+    uint8_t _depth = 0;
+    uint8_t _edepth = 0;
+    uint16_t _key_len = 0;
+    uint8_t _val_len = 0;
+    char _key[GSON_MAX_KEY_LEN + 1];
+    char _val[GSON_STREAM_VAL_LEN + 1];
+    Type _type = Type::None;
+    Error _err = Error::None;
+    bool _wantKey = false;
+    bool _pending = false;  // строковое значение ещё не прочитано
+    bool _done = false;
+    uint8_t _mark = 0;       // начало события в буфере (откат при Event::More)
+    bool _mkey = false;      // _wantKey на начало события
+    bool _wait = true;
+    bool _nb = false;        // next() без ожидания
+    bool _nodata = false;    // без ожидания данные кончились
+
+    Event _next() {
+        _mkey = _wantKey;
+        if (_pending && !_skipString()) return _fail(Error::BrokenString);
+        _mark = _bpos;
+
+        while (true) {
+            int c = _get();
+            if (c < 0) return _fail(_depth ? Error::BrokenContainer : Error::EmptyString);
+
+            switch (c) {
+                case ' ':
+                case '\t':
+                case '\r':
+                case '\n':
+                case ':':
+                    break;
+
+                case ',':
+                    if (!_depth) return _fail(Error::UnexComma);
+                    _wantKey = !_isArray(_depth);
+                    break;
+
+                case '{':
+                case '[':
+                    if (_depth >= GSON_STREAM_DEPTH) return _fail(Error::TooDeep);
+                    if (_wantKey) return _fail(Error::UnexOpen);
+                    _element();
+                    _depth++;
+                    if (c == '[') _arr |= (1ul << _depth);
+                    else _arr &= ~(1ul << _depth);
+                    _idx[_depth] = 0;
+                    _wantKey = (c == '{');
+                    _type = (c == '{') ? Type::Object : Type::Array;
+                    return (c == '{') ? Event::Object : Event::Array;
+
+                case '}':
+                case ']':
+                    if (!_depth || _isArray(_depth) != (c == ']')) return _fail(Error::UnexClose);
+                    _edepth = --_depth;
+                    _wantKey = false;
+                    _key_len = 0;
+                    _key[0] = 0;
+                    _type = Type::None;
+                    if (!_depth) _done = true;
+                    return Event::End;
+
+                case '\"':
+                    if (!_depth) return _fail(Error::NotContainer);
+                    if (_wantKey) {
+                        if (!_readKey()) return _fail(Error::BrokenString);
+                        _wantKey = false;
+                        break;
+                    }
+                    if (_nb && !_strReady()) return _more();
+                    _element();
+                    _type = Type::String;
+                    _val_len = 0;
+                    _val[0] = 0;
+                    _pending = true;
+                    return Event::Value;
+
+                default:
+                    if (!_depth) return _fail(Error::NotContainer);
+                    if (_wantKey) return _fail(Error::UnexToken);
+                    if (!_readToken(c) || _nodata) return hasError() ? Event::None : _fail(Error::BrokenToken);
+                    _element();
+                    return Event::Value;
+            }
+        }
+    }
+
+    Event _fail(Error err) {
+        if (_nodata) return _more();
+        _err = err;
+        _pending = false;
+        return Event::None;
+    }
+
+    // данных нет: откатить событие к началу, чтобы повторить его целиком
+    Event _more() {
+        _nodata = false;
+        _bpos = _mark;
+        _wantKey = _mkey;
+        return Event::More;
+    }
+
+    bool _isArray(uint8_t depth) const {
+        return _arr & (1ul << depth);
+    }
+
+    int _get() {
+        if (_bpos >= _blen && !_fill()) return -1;
+        return _buf[_bpos++];
+    }
+
+    // в буфере есть n символов (n < GSON_STREAM_BUF)
+    bool _ahead(uint8_t n) {
+        while (_blen - _bpos < n) {
+            if (!_fill()) return false;
+        }
+        return true;
+    }
+
+    // дочитать в буфер то, что уже пришло в поток (хотя бы символ, с таймаутом потока).
+    // Непрочитанное сдвигается в начало буфера, без ожидания - вместе с прочитанным с начала события (_mark)
+    bool _fill() {
+        if (_nb && _blen - _mark >= GSON_STREAM_BUF) _nb = false;  // событие не помещается в буфер - дочитать с ожиданием
+        uint8_t from = _nb ? _mark : _bpos;
+        uint8_t keep = _blen - from;
+        if (keep && from) memmove(_buf, _buf + from, keep);
+        _bpos -= from;
+        _blen = keep;
+        _mark = 0;
+        size_t room = GSON_STREAM_BUF - keep;
+        if (!room) return false;
+        int av = _arrived();
+        if (_nb && av <= 0) {
+            _nodata = true;
+            return false;
+        }
+        size_t n = _s->readBytes((char*)_buf + keep, av > 1 ? min((size_t)av, room) : 1);
+        _blen += n;
+        return n;
+    }
+
+    // символов пришло в поток. available() у ридера тела HTTP - весь остаток тела, поэтому по буферу peek API
+    int _arrived() {
+#ifdef GSON_PEEK_API
+        if (_s->hasPeekBufferAPI()) {
+            size_t n = _s->peekAvailable();
+            if (!n) {
+                _s->available();  // прокачать TLS
+                n = _s->peekAvailable();
+            }
+            return n;
+        }
+#endif
+        return _s->available();
+    }
+
+    // без ожидания: строковое значение пришло до закрывающей кавычки или не поместится в буфер
+    bool _strReady() {
+        size_t i = _bpos;
+        while (true) {
+            for (; i < _blen; i++) {
+                if (_buf[i] == '\\') i++;
+                else if (_buf[i] == '\"') return true;
+            }
+            if (_blen - _mark >= GSON_STREAM_BUF) return true;
+            i -= _mark;  // _fill сдвигает буфер к _mark
+            if (!_fill()) return false;
+        }
+    }
+
+    // новый элемент текущего контейнера
+    void _element() {
+        _edepth = _depth;
+        _index = _depth ? _idx[_depth]++ : 0;
+        if (!_depth || _isArray(_depth)) {
+            _key_len = 0;
+            _key[0] = 0;
+        }
+    }
+
+    // пропустить остаток строки. Без ожидания пропускает пришедшее, откат (_mark) - к началу символа
+    bool _skipString() {
+        while (true) {
+            _mark = _bpos;
+            size_t run = _sub._run();
+            if (run) _sub._consume(run);
+            else if (_sub._char() < 0) break;
+        }
+        return !hasError() && !_nodata;
+    }
+
+    // ключ до кавычки, длиннее GSON_MAX_KEY_LEN обрезается
+    bool _readKey() {
+        _key_len = 0;
+        while (true) {
+            int c = _get();
+            if (c < 0) return false;
+            if (c == '\"') break;
+            if (c == '\\') c = _get();
+            if (c < 0) return false;
+            if (_key_len < GSON_MAX_KEY_LEN) _key[_key_len++] = c;
+        }
+        _key[_key_len] = 0;
+        return true;
+    }
+
+    // число, true, false, null до разделителя
+    bool _readToken(int c) {
+        switch (c) {
+            case 't':
+            case 'f':
+                _type = Type::Bool;
+                break;
+            case 'n':
+                _type = Type::Null;
+                break;
+            case '-':
+            case '0' ... '9':
+                _type = Type::Int;
+                break;
+            default:
+                _err = Error::UnknownToken;
+                return false;
+        }
+        _val_len = 0;
+        while (true) {
+            if (_val_len >= GSON_STREAM_VAL_LEN) return false;
+            if (c == '.' || c == 'e' || c == 'E') {
+                if (_type == Type::Int || _type == Type::Float) _type = Type::Float;
+                else if (c == '.') return false;
+            }
+            _val[_val_len++] = c;
+            c = _get();
+            if (c < 0) break;
+            if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+                _bpos--;  // разделитель - следующему next()
+                break;
+            }
+        }
+        _val[_val_len] = 0;
+        if (_type == Type::Bool) return !strcmp_P(_val, PSTR("true")) || !strcmp_P(_val, PSTR("false"));
+        if (_type == Type::Null) return !strcmp_P(_val, PSTR("null"));
+        return true;
+    }
+};
+
+}  // namespace gson
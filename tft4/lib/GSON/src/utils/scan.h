@@ -0,0 +1,215 @@
+#pragma once
+#include <Arduino.h>
+
+// Stage 1: разметка JSON блоками по 64 байта на SIMD хоста (SSE2/AVX2/NEON). Для блока строятся
+// битовые маски кавычек, '\', пробелов и структурных символов, из них - маска позиций, с которых
+// начинается токен: {}[],: вне строк, открывающая кавычка и первый символ числа/true/false/null.
+// Парсер переходит по этим позициям, не перебирая символы. Кавычка экранирована, если перед ней
+// '\' - то же правило, что у парсера.
+// Включается дефайном GSON_SCAN и только с SIMD хоста. Выигрыш есть на длинных строках и отступах,
+// на плотном JSON его нет (tft4/bench, gson_bench). На машинных словах (SWAR) разметка медленнее
+// посимвольного разбора, поэтому на ESP8266 и Cortex-M её нет
+
+#if defined(GSON_SCAN)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GSON_SCAN_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define GSON_SCAN_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define GSON_SCAN_NEON
+#else
+#undef GSON_SCAN
+#endif
+#endif
+
+#ifdef GSON_SCAN
+
+namespace gsutil {
+
+typedef uint64_t scan_t;
+
+class Scanner {
+   public:
+    static constexpr uint8_t BLOCK = 64;
+
+    // маски символов блока, бит i - байт i
+    struct Masks {
+        scan_t quote;  // "
+        scan_t bslash;  // '\'
+        scan_t ws;      // пробел, \t, \r, \n (и прочие управляющие)
+        scan_t open;    // { [
+        scan_t comma;   // ,
+        scan_t other;   // } ] :
+    };
+
+    // начать разметку строки
+    void begin(const char* str, const char* end) {
+        _end = end;
+        _load(str, 0, 0, 0);
+    }
+
+    // первая позиция токена после p (p - разобранный символ вне строки). Конец строки - end
+    const char* next(const char* p) {
+        if (p >= _base + BLOCK) {
+            // парсер ушёл за блок (длинная строка или токен) - разметка заново от p, снаружи строки
+            _load(p + 1, 0, 0, 0);
+        } else {
+            _bits &= (~(scan_t)0 << (p - _base)) << 1;
+        }
+        while (!_bits) {
+            if (_base + BLOCK >= _end) return _end;
+            _load(_base + BLOCK, _in_str, _bs, _scalar);
+        }
+        return _base + _ctz(_bits);
+    }
+
+    // оценка количества элементов: { [ считаются за два, запятая - за один
+    static uint16_t count(const char* str, const char* end) {
+        uint32_t count = 0;
+        scan_t in = 0, bs = 0;
+        for (const char* p = str; p < end; p += BLOCK) {
+            Masks m;
+            _classify(p, end, m);
+            scan_t instr = _strings(m, in, bs);
+            count += 2 * _popcount(m.open & ~instr) + _popcount(m.comma & ~instr);
+        }
+        return count > 0xffff ? 0xffff : count;
+    }
+
+    // маски блока с p, за end - пробелы
+    static inline void _classify(const char* p, const char* end, Masks& m) {
+        if (end - p < BLOCK) {
+            char buf[BLOCK];
+            memset(buf, ' ', BLOCK);
+            memcpy(buf, p, end - p);
+            _classifyBlock(buf, m);
+        } else {
+            _classifyBlock(p, m);
+        }
+    }
+
+   private:
+    const char* _base = nullptr;
+    const char* _end = nullptr;
+    scan_t _bits = 0;
+    scan_t _in_str = 0;  // блок начинается внутри строки (все единицы)
+    scan_t _bs = 0;      // блок начинается после '\'
+    scan_t _scalar = 0;  // блок начинается внутри токена
+
+    static inline uint8_t _ctz(scan_t x) {
+        return __builtin_ctzll(x);
+    }
+    static inline uint8_t _popcount(scan_t x) {
+        return __builtin_popcountll(x);
+    }
+
+    void _load(const char* p, scan_t in, scan_t bs, scan_t scalar) {
+        _base = p;
+        if (p >= _end) {
+            _bits = 0;
+            return;
+        }
+        Masks m;
+        _classify(p, _end, m);
+        _in_str = in;
+        _bs = bs;
+        scan_t instr = _strings(m, _in_str, _bs);
+        scan_t str = m.open | m.comma | m.other;
+        scan_t sc = ~(m.ws | str | m.quote | instr);
+        _bits = (str & ~instr) | (m.quote & instr) | (sc & ~((sc << 1) | scalar));
+        _scalar = sc >> (BLOCK - 1);
+    }
+
+    // маска строк блока [открывающая кавычка, закрывающая). in, bs - переносы между блоками
+    static scan_t _strings(const Masks& m, scan_t& in, scan_t& bs) {
+        scan_t q = m.quote & ~((m.bslash << 1) | bs);
+        bs = m.bslash >> (BLOCK - 1);
+        // префиксный XOR: единицы от каждой нечётной кавычки до следующей
+        q ^= q << 1;
+        q ^= q << 2;
+        q ^= q << 4;
+        q ^= q << 8;
+        q ^= q << 16;
+        q ^= q << 32;
+        q ^= in;
+        in = (scan_t)0 - (q >> (BLOCK - 1));
+        return q;
+    }
+
+#if defined(GSON_SCAN_AVX2)
+    static uint32_t _mask32(__m256i x, __m256i c) {
+        return _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, c));
+    }
+    static void _classifyBlock(const char* p, Masks& m) {
+        const __m256i q = _mm256_set1_epi8('\"'), b = _mm256_set1_epi8('\\'), sp = _mm256_set1_epi8(' ');
+        const __m256i o = _mm256_set1_epi8('{'), c = _mm256_set1_epi8('}'), cm = _mm256_set1_epi8(','), cl = _mm256_set1_epi8(':');
+        const __m256i lo = _mm256_set1_epi8(0x20);
+        uint64_t r[6] = {};
+        for (uint8_t i = 0; i < 2; i++) {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(p + i * 32));
+            __m256i y = _mm256_or_si256(x, lo);  // [ -> {, ] -> }
+            uint8_t sh = i * 32;
+            r[0] |= (uint64_t)_mask32(x, q) << sh;
+            r[1] |= (uint64_t)_mask32(x, b) << sh;
+            r[2] |= (uint64_t)_mask32(_mm256_max_epu8(x, sp), sp) << sh;
+            r[3] |= (uint64_t)_mask32(y, o) << sh;
+            r[4] |= (uint64_t)_mask32(x, cm) << sh;
+            r[5] |= (uint64_t)(_mask32(y, c) | _mask32(x, cl)) << sh;
+        }
+        m = {r[0], r[1], r[2], r[3], r[4], r[5]};
+    }
+
+#elif defined(GSON_SCAN_SSE2)
+    static uint32_t _mask16(__m128i x, __m128i c) {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(x, c));
+    }
+    static void _classifyBlock(const char* p, Masks& m) {
+        const __m128i q = _mm_set1_epi8('\"'), b = _mm_set1_epi8('\\'), sp = _mm_set1_epi8(' ');
+        const __m128i o = _mm_set1_epi8('{'), c = _mm_set1_epi8('}'), cm = _mm_set1_epi8(','), cl = _mm_set1_epi8(':');
+        const __m128i lo = _mm_set1_epi8(0x20);
+        uint64_t r[6] = {};
+        for (uint8_t i = 0; i < 4; i++) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(p + i * 16));
+            __m128i y = _mm_or_si128(x, lo);  // [ -> {, ] -> }
+            uint8_t sh = i * 16;
+            r[0] |= (uint64_t)_mask16(x, q) << sh;
+            r[1] |= (uint64_t)_mask16(x, b) << sh;
+            r[2] |= (uint64_t)_mask16(_mm_max_epu8(x, sp), sp) << sh;
+            r[3] |= (uint64_t)_mask16(y, o) << sh;
+            r[4] |= (uint64_t)_mask16(x, cm) << sh;
+            r[5] |= (uint64_t)(_mask16(y, c) | _mask16(x, cl)) << sh;
+        }
+        m = {r[0], r[1], r[2], r[3], r[4], r[5]};
+    }
+
+#elif defined(GSON_SCAN_NEON)
+    static uint64_t _mask16(uint8x16_t v) {
+        static const uint8_t bits[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+        uint8x16_t t = vandq_u8(v, vld1q_u8(bits));
+        return vaddv_u8(vget_low_u8(t)) | ((uint64_t)vaddv_u8(vget_high_u8(t)) << 8);
+    }
+    static void _classifyBlock(const char* p, Masks& m) {
+        uint64_t r[6] = {};
+        for (uint8_t i = 0; i < 4; i++) {
+            uint8x16_t x = vld1q_u8((const uint8_t*)p + i * 16);
+            uint8x16_t y = vorrq_u8(x, vdupq_n_u8(0x20));  // [ -> {, ] -> }
+            uint8_t sh = i * 16;
+            r[0] |= _mask16(vceqq_u8(x, vdupq_n_u8('\"'))) << sh;
+            r[1] |= _mask16(vceqq_u8(x, vdupq_n_u8('\\'))) << sh;
+            r[2] |= _mask16(vcleq_u8(x, vdupq_n_u8(' '))) << sh;
+            r[3] |= _mask16(vceqq_u8(y, vdupq_n_u8('{'))) << sh;
+            r[4] |= _mask16(vceqq_u8(x, vdupq_n_u8(','))) << sh;
+            r[5] |= _mask16(vorrq_u8(vceqq_u8(y, vdupq_n_u8('}')), vceqq_u8(x, vdupq_n_u8(':')))) << sh;
+        }
+        m = {r[0], r[1], r[2], r[3], r[4], r[5]};
+    }
+
+#endif
+};
+
+}  // namespace gsutil
+
+#endif  // GSON_SCAN
@@ -5,43 +5,71 @@
 
 namespace gson {
 
+// Print-пустышка: только считает байты. Для пробного прохода string(Print&) - узнать длину заранее
+class Counter : public Print {
+   public:
+    size_t write(uint8_t) {
+        _len++;
+        return 1;
+    }
+    size_t write(const uint8_t*, size_t len) {
+        _len += len;
+        return len;
+    }
+
+    // напечатано байт
+    size_t length() const {
+        return _len;
+    }
+
+   private:
+    size_t _len = 0;
+};
+
 class string : public Printable {
    public:
     string(uint16_t res = 0) {
         if (res) reserve(res);
     }
 
-    // доступ к строке
+    // потоковый режим: пакет сразу печатается в p, без строки в памяти.
+    // Запятая после значения придерживается до следующего символа, чтобы её можно было заменить.
+    // Строки пакета нет: s, String& и Text пустые, printTo ничего не печатает, длина - length()
+    string(Print& p) : _p(&p) {}
+
+    // доступ к строке (пустая в потоковом режиме)
     String s;
 
-    // доступ к строке
+    // доступ к строке (пустая в потоковом режиме)
     operator String&() {
         return s;
     }
 
-    // доступ к строке
+    // доступ к строке (пустая в потоковом режиме)
     operator Text() {
         return s;
     }
 
-    // Напечатать в Print
+    // Напечатать в Print. В потоковом режиме пакет уже напечатан - 0
     size_t printTo(Print& p) const {
-        return p.print(s);
+        return _p ? 0 : p.print(s);
     }
 
     // очистить строку
     void clear() {
         s = "";
+        _len = 0;
+        _comma = false;
     }
 
-    // длина строки
-    uint16_t length() const {
-        return s.length();
+    // длина строки (в потоковом режиме - сколько напечатано)
+    size_t length() const {
+        return _p ? _len : s.length();
     }
 
     // зарезервировать строку
     bool reserve(uint16_t res) {
-        return s.reserve(res);
+        return _p ? true : s.reserve(res);
     }
 
     // завершить пакет
@@ -54,7 +82,10 @@ class string : public Printable {
 
     // прибавить gson::string. Будет добавлена запятая
     string& add(const string& str) {
-        s += str.s;
+        uint16_t len = str.s.length();
+        // запятую в конце str в потоке не печатать сразу - её придержит replaceComma
+        if (_p && len && str.s[len - 1] == ',') len--;
+        _put(Text(str.s.c_str(), len));
         replaceComma(',');
         return *this;
     }
@@ -231,7 +262,7 @@ class string : public Printable {
 
     // добавить bool без запятой
     string& addBoolRaw(const bool& value) {
-        s += value ? F("true") : F("false");
+        _put(value ? F("true") : F("false"));
         return *this;
     }
 
@@ -263,11 +294,11 @@ class string : public Printable {
 
     // добавить float без запятой
     string& addFloatRaw(const double& value, uint8_t dec = 2) {
-        if (isnan(value)) s += '0';
+        if (isnan(value)) _put('0');
         else {
             char buf[33];
             dtostrf(value, dec + 2, dec, buf);
-            s += buf;
+            _put(buf);
         }
         return *this;
     }
@@ -295,7 +326,7 @@ class string : public Printable {
     // добавить int
     string& addInt(const Value& value) {
         if (value.valid()) {
-            value.addString(s);
+            _put(value);
             comma();
         }
         return *this;
@@ -303,7 +334,7 @@ class string : public Printable {
 
     // добавить int без запятой
     string& addIntRaw(const Value& value) {
-        if (value.valid()) value.addString(s);
+        if (value.valid()) _put(value);
         return *this;
     }
 #else
@@ -320,7 +351,7 @@ class string : public Printable {
     // добавить int
     template <typename T>
     string& addInt(T value) {
-        s += value;
+        _put(String(value));
         comma();
         return *this;
     }
@@ -328,7 +359,7 @@ class string : public Printable {
     // добавить int без запятой
     template <typename T>
     string& addIntRaw(T value) {
-        s += value;
+        _put(String(value));
         return *this;
     }
 #endif
@@ -356,7 +387,7 @@ class string : public Printable {
     // начать объект
     string& beginObj(const Text& key = Text()) {
         addKey(key);
-        s += '{';
+        _put('{');
         return *this;
     }
 
@@ -370,7 +401,7 @@ class string : public Printable {
     // начать массив
     string& beginArr(const Text& key = Text()) {
         addKey(key);
-        s += '[';
+        _put('[');
         return *this;
     }
 
@@ -384,17 +415,22 @@ class string : public Printable {
     // запятая
     void comma() {
         afterValue();
-        s += ',';
+        if (_p) {
+            _flush();
+            _comma = true;
+        } else {
+            s += ',';
+        }
     }
 
     // двойные кавычки
     void quotes() {
-        s += '\"';
+        _put('\"');
     }
 
     // двоеточие
     void colon() {
-        s += ':';
+        _put(':');
     }
 
     // делать escape символов при прибавлении через оператор = (умолч. вкл, true)
@@ -416,23 +452,23 @@ class string : public Printable {
             switch (c) {
                 case '\"':
                 case '\\':
-                    if (p != '\\') s += '\\';
-                    s += c;
+                    if (p != '\\') _put('\\');
+                    _put(c);
                     break;
                 case '\n':
-                    s += '\\';
-                    s += 'n';
+                    _put('\\');
+                    _put('n');
                     break;
                 case '\r':
-                    s += '\\';
-                    s += 'r';
+                    _put('\\');
+                    _put('r');
                     break;
                 case '\t':
-                    s += '\\';
-                    s += 't';
+                    _put('\\');
+                    _put('t');
                     break;
                 default:
-                    s += c;
+                    _put(c);
                     break;
             }
             p = c;
@@ -441,6 +477,12 @@ class string : public Printable {
 
     // заменить последнюю запятую символом. Если символ '\0' - удалить запятую. Если это не запятая - добавить символ
     void replaceComma(char sym) {
+        if (_p) {
+            _comma = false;
+            if (sym == ',') _comma = true;
+            else if (sym) _put(sym);
+            return;
+        }
         int16_t len = s.length() - 1;
         if (s[len] == ',') {
             if (!sym) s.remove(len);
@@ -451,15 +493,46 @@ class string : public Printable {
     }
 
    private:
+    Print* _p = nullptr;
+    size_t _len = 0;
+    bool _comma = false;
     bool _esc = true;
 
+    // прибавить символ
+    void _put(char c) {
+        if (_p) {
+            _flush();
+            _len += _p->write(c);
+        } else {
+            s += c;
+        }
+    }
+
+    // прибавить текст
+    void _put(const Text& text) {
+        if (_p) {
+            _flush();
+            _len += text.printTo(*_p);
+        } else {
+            text.addString(s);
+        }
+    }
+
+    // допечатать придержанную запятую
+    void _flush() {
+        if (_comma) {
+            _comma = false;
+            _len += _p->write(',');
+        }
+    }
+
     void _addRaw(const Text& text, bool quot, bool esc) {
         if (quot) quotes();
         if (esc) {
-            if (!s.reserve(s.length() + text.length())) return;
+            if (!reserve(s.length() + text.length())) return;
             escape(text);
         } else {
-            text.addString(s);
+            _put(text);
         }
         if (quot) quotes();
     }
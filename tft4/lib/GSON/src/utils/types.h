@@ -48,6 +48,7 @@ enum class Error : uint8_t {
     LongPacket,
     LongKey,
     EmptyString,
+    Filter,
 };
 
 static const __FlashStringHelper* readError(Error e) {
@@ -71,6 +72,7 @@ static const __FlashStringHelper* readError(Error e) {
         case Error::LongPacket: return F("LongPacket");
         case Error::LongKey: return F("LongKey");
         case Error::EmptyString: return F("EmptyString");
+        case Error::Filter: return F("Filter");
         default: return F("None");
     }
 }
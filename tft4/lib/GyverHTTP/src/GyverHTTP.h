@@ -0,0 +1,7 @@
+#pragma once
+
+#include "./utils/Client.h"
+#include "./utils/EspClient.h"
+#include "./utils/HeadersParser.h"
+#include "./utils/Server.h"
+#include "./utils/ServerBase.h"
\ No newline at end of file
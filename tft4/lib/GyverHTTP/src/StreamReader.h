@@ -0,0 +1,444 @@
+#pragma once
+#include <Arduino.h>
+#include <StringUtils.h>
+
+#include "utils/Timing.h"
+#include "utils/cfg.h"
+
+// #define GHTTP_INFLATE  // распаковка тела Content-Encoding: gzip/deflate (+окно GHTTP_INFLATE_WINDOW в куче на время ответа)
+
+#ifdef GHTTP_INFLATE
+#include "utils/Inflate.h"
+#endif
+
+#define READER_DEF_TOUT 500
+
+#ifndef READER_BUF_LEN
+#define READER_BUF_LEN 256  // буфер writeTo на стеке, если у потока нет peek API
+#endif
+
+// ==================== READER ====================
+class StreamReader : public Stream {
+    class WritableString : public String {
+       public:
+        size_t write(uint8_t* data, size_t len) {
+            return concat((char*)data, len) ? len : 0;
+        }
+    };
+
+   public:
+    class Buffer {
+       public:
+        size_t write(uint8_t* data, size_t len) {
+            return s.concat((char*)data, len) ? len : 0;
+        }
+
+        uint8_t* buf() {
+            return (uint8_t*)s.c_str();
+        }
+        size_t length() {
+            return s.length();
+        }
+
+       private:
+        String s;
+    };
+
+    StreamReader(Stream* stream = nullptr, size_t len = 0, bool chunked = false) : stream(stream), _len(len), _tout(stream ? stream->getTimeout() : READER_DEF_TOUT), _chunked(chunked) {}
+
+#ifdef GHTTP_INFLATE
+    // распаковщик принадлежит ридеру, ридер только перемещается
+    StreamReader(const StreamReader&) = delete;
+    StreamReader& operator=(const StreamReader&) = delete;
+
+    StreamReader(StreamReader&& r) {
+        *this = static_cast<StreamReader&&>(r);
+    }
+    StreamReader& operator=(StreamReader&& r) {
+        if (this == &r) return *this;
+        delete _inf;
+        stream = r.stream;
+        _len = r._len;
+        _bsize = r._bsize;
+        _chunklen = r._chunklen;
+        _tout = r._tout;
+        _digits = r._digits;
+        _cstate = r._cstate;
+        _chunked = r._chunked;
+        _error = r._error;
+        _inf = r._inf;
+        _obs = r._obs;
+        _seq = r._seq;
+        _bytes = r._bytes;
+        r._inf = nullptr;
+        r._obs = nullptr;
+        r.stream = nullptr;
+        return *this;
+    }
+
+    ~StreamReader() {
+        delete _inf;
+    }
+
+    // распаковывать тело на лету: gzip или deflate (zlib). false - нет памяти, тело не прочитать
+    bool inflate(bool gzip) {
+        if (!stream || (!_chunked && !_len)) return true;  // тела нет
+        delete _inf;
+        _inf = new ghttp::Inflate(gzip);
+        if (!_inf || _inf->error()) return _fail();
+        return true;
+    }
+
+    // тело распаковывается
+    bool isInflated() {
+        return _inf;
+    }
+#endif
+
+    // ограничить блок, отдаваемый в writeTo за раз (0 - без ограничения, блок равен записи TLS или буферу)
+    void setBlockSize(size_t bsize) {
+        _bsize = bsize;
+    }
+
+    void setTimeout(size_t tout) {
+        _tout = tout;
+        if (stream) stream->setTimeout(tout);
+    }
+
+    // сообщить obs о конце тела (замеры ghttp::Client). seq возвращается в bodyEnd
+    void observe(ghttp::BodyObserver* obs, uint8_t seq) {
+        _obs = obs;
+        _seq = seq;
+    }
+
+    // http chunked response
+    bool isChunked() {
+        return _chunked;
+    }
+
+    // корреткность ридера
+    operator bool() {
+        return available();
+    }
+
+    // оставшийся размер входящих данных. 1 если chunked
+    size_t length() {
+        return available();
+    }
+
+    // override
+    size_t write(uint8_t) { return 0; }
+
+    int available() {
+#ifdef GHTTP_INFLATE
+        // длина распакованного неизвестна. Тело кончилось, когда кончился вход и распаковщик всё отдал
+        if (_inf) return (stream || (!_inf->done() && !_inf->error())) ? 1 : 0;
+#endif
+        return stream ? (_chunked ? 1 : _len) : 0;
+    }
+
+    int read() {
+        if (!available()) return -1;
+        char c;
+        return readBytes(&c, 1) ? (uint8_t)c : -1;
+    }
+
+    int peek() {
+        return '0';
+    }
+
+    Buffer readBuffer() {
+        Buffer b;
+        writeTo(b);
+        return b;
+    }
+
+    bool readBuffer(Buffer& b) {
+        return writeTo(b);
+    }
+
+    String readString() {
+        WritableString s;
+        writeTo(s);
+        return s;
+    }
+
+    // прочитать тело, уже пришедшее в поток, не дожидаясь остального. Вернёт количество прочитанных, 0 - данных пока нет.
+    // Конец тела - available() == 0
+    size_t readAvailable(uint8_t* buf, size_t len) {
+#ifdef GHTTP_INFLATE
+        if (_inf) return _inflate(buf, len);
+#endif
+        return _readRaw(buf, len);
+    }
+
+    // прочитать length байт тела с ожиданием (таймаут на каждую порцию). Вернёт количество прочитанных
+    size_t readBytes(char* buffer, size_t length) {
+        size_t wasread = 0;
+        while (length) {
+            size_t n = readAvailable((uint8_t*)buffer, length);
+            if (!n) {
+                if (!available() || !_wait()) break;
+                continue;
+            }
+            wasread += n;
+            buffer += n;
+            length -= n;
+        }
+        return wasread;
+    }
+
+#ifdef GHTTP_PEEK_API
+    // peek buffer API: тело отдаётся из буфера TLS без копирования, разметка chunked снимается по пути.
+    // Распакованное тело - только копией
+    bool hasPeekBufferAPI() const override {
+#ifdef GHTTP_INFLATE
+        if (_inf) return false;
+#endif
+        return stream && stream->hasPeekBufferAPI();
+    }
+
+    size_t peekAvailable() override {
+        if (!hasPeekBufferAPI()) return 0;
+        size_t n = _ready();
+        return n ? min(stream->peekAvailable(), n) : 0;
+    }
+
+    const char* peekBuffer() override {
+        return hasPeekBufferAPI() ? stream->peekBuffer() : nullptr;
+    }
+
+    void peekConsume(size_t consume) override {
+        consume = min(consume, peekAvailable());
+        if (!consume) return;
+        stream->peekConsume(consume);
+        _consumed(consume);
+    }
+#endif
+
+    // вывести всё в write(uint8_t*, size_t) блоками по мере прихода. Вернёт количество записанных или 0 при ошибке.
+    // С peek API пишет прямо из буфера TLS, иначе через буфер на стеке
+    template <typename T>
+    size_t writeTo(T& p) {
+        uint8_t buf[READER_BUF_LEN];
+        return writeTo(p, buf, sizeof(buf));
+    }
+
+    // вывести всё в write(uint8_t*, size_t) через буфер программы buf размером len (без peek API или с распаковкой)
+    template <typename T>
+    size_t writeTo(T& p, uint8_t* buf, size_t len) {
+        if (_bsize && len > _bsize) len = _bsize;
+        size_t writed = 0;
+        while (available()) {
+            size_t n;
+            uint8_t* data = buf;
+#ifdef GHTTP_PEEK_API
+            size_t peek = peekAvailable();
+            if (peek) {
+                n = (_bsize && peek > _bsize) ? _bsize : peek;
+                data = (uint8_t*)peekBuffer();
+            } else
+#endif
+            {
+                n = readAvailable(buf, len);
+            }
+            if (!n) {
+                if (!_wait()) break;
+                continue;
+            }
+            if (p.write(data, n) != n) {
+                _fail();
+                break;
+            }
+#ifdef GHTTP_PEEK_API
+            if (peek) peekConsume(n);
+#endif
+            writed += n;
+            GHTTP_ESP_YIELD();
+        }
+        return _error ? 0 : writed;
+    }
+
+    // тело прочитано с ошибкой (разметка chunked, сжатие, таймаут, отказ приёмника)
+    bool error() {
+        return _error;
+    }
+
+    Stream* stream = nullptr;
+
+   private:
+    // тело как пришло (без распаковки), не дожидаясь остального
+    size_t _readRaw(uint8_t* buf, size_t len) {
+        size_t n = _ready();
+        if (n > len) n = len;
+        if (!n) return 0;
+#ifdef GHTTP_PEEK_API
+        size_t peek = stream->hasPeekBufferAPI() ? stream->peekAvailable() : 0;
+        if (peek) {
+            if (n > peek) n = peek;
+            memcpy(buf, stream->peekBuffer(), n);
+            stream->peekConsume(n);
+            return _consumed(n);
+        }
+#endif
+        return _consumed(stream->readBytes((char*)buf, n));
+    }
+
+    // разметка chunked
+    enum class Chunk : uint8_t {
+        Size,     // длина hex
+        Ext,      // расширение после ;
+        SizeLF,   // \n после длины
+        Data,     // данные чанка
+        DataCR,   // \r после данных
+        DataLF,   // \n после данных
+        Trailer,  // заголовки после последнего чанка
+    };
+
+    size_t _len;
+    size_t _bsize = 0;
+    size_t _chunklen = 0;
+    size_t _tout;
+    uint8_t _digits = 0;  // символов в строке длины или трейлера
+    Chunk _cstate = Chunk::Size;
+    bool _chunked = false;
+    bool _error = false;
+    uint8_t _seq = 0;
+    size_t _bytes = 0;  // байт тела из потока (без разметки chunked)
+    ghttp::BodyObserver* _obs = nullptr;
+#ifdef GHTTP_INFLATE
+    ghttp::Inflate* _inf = nullptr;
+
+    // распаковать, подкачивая сжатые данные, пока они есть
+    size_t _inflate(uint8_t* buf, size_t len) {
+        while (true) {
+            size_t n = _inf->read(buf, len, !stream);
+            if (_inf->error()) _fail();  // ошибка могла случиться после выданной части
+            else if (!stream && _inf->done()) _notify(true);
+            if (n || _error) return n;
+            if (_inf->done()) {
+                // хвост после сжатых данных пропускается, чтобы соединение осталось целым
+                uint8_t tmp[16];
+                while (_readRaw(tmp, sizeof(tmp))) {
+                }
+                return 0;
+            }
+            if (!stream) return _fail();  // вход кончился раньше сжатых данных
+            size_t r = _readRaw(_inf->tail(), _inf->reserve());
+            if (!r && stream) return 0;  // ждём вход. Если вход только что кончился - дораспаковать с last
+            _inf->fill(r);
+        }
+    }
+#endif
+
+    // байт тела, которые можно прочитать сейчас без ожидания. Разметку chunked снимает по мере прихода
+    size_t _ready() {
+        if (!stream) return 0;
+        if (!_chunked) return min(_len, (size_t)stream->available());
+        while (_cstate != Chunk::Data) {
+            if (!stream->available()) return 0;
+            if (!_frame(stream->read()) || !stream) return 0;
+        }
+        return min(_chunklen, (size_t)stream->available());
+    }
+
+    // символ разметки chunked. false - ошибка
+    bool _frame(int c) {
+        switch (_cstate) {
+            case Chunk::Size:
+                if (c >= '0' && c <= '9') c -= '0';
+                else if (c >= 'a' && c <= 'f') c -= 'a' - 10;
+                else if (c >= 'A' && c <= 'F') c -= 'A' - 10;
+                else if (_digits && c == ';') {
+                    _cstate = Chunk::Ext;
+                    break;
+                } else if (_digits && c == '\r') {
+                    _cstate = Chunk::SizeLF;
+                    break;
+                } else return _fail();
+                if (++_digits > sizeof(size_t) * 2) return _fail();  // переполнение длины
+                _chunklen = (_chunklen << 4) | c;
+                break;
+
+            case Chunk::Ext:
+                if (c == '\r') _cstate = Chunk::SizeLF;
+                break;
+
+            case Chunk::SizeLF:
+                if (c != '\n') return _fail();
+                _digits = 0;
+                _cstate = _chunklen ? Chunk::Data : Chunk::Trailer;
+                break;
+
+            case Chunk::DataCR:
+                if (c != '\r') return _fail();
+                _cstate = Chunk::DataLF;
+                break;
+
+            case Chunk::DataLF:
+                if (c != '\n') return _fail();
+                _cstate = Chunk::Size;
+                break;
+
+            case Chunk::Trailer:
+                if (c == '\n') {
+                    if (!_digits) _end(true);  // пустая строка - конец тела
+                    _digits = 0;
+                } else if (c != '\r') {
+                    _digits = 1;
+                }
+                break;
+
+            default:
+                break;
+        }
+        return true;
+    }
+
+    // снять n прочитанных байт тела
+    size_t _consumed(size_t n) {
+        _bytes += n;
+        if (_chunked) {
+            _chunklen -= n;
+            if (!_chunklen) _cstate = Chunk::DataCR;
+        } else {
+            _len -= n;
+            if (!_len) _end(true);
+        }
+        return n;
+    }
+
+    bool _fail() {
+        _error = true;
+        _end(false);
+        return false;
+    }
+
+    // тело из потока кончилось. Сжатое считается прочитанным, когда распаковщик дошёл до конца
+    void _end(bool ok) {
+        stream = nullptr;
+#ifdef GHTTP_INFLATE
+        if (ok && _inf && !_inf->done()) return;
+#endif
+        _notify(ok);
+    }
+
+    void _notify(bool ok) {
+        if (!_obs) return;
+        ghttp::BodyObserver* obs = _obs;
+        _obs = nullptr;
+        obs->bodyEnd(_seq, _bytes, ok);
+    }
+
+    // дождаться данных тела, опрос раз в миллисекунду (delay отдаёт время стеку WiFi). false - тело закончилось, ошибка или таймаут
+    bool _wait() {
+        uint32_t tmr = millis();
+        while (stream) {
+            if (_ready()) return true;
+            if (!stream) break;
+            if (millis() - tmr >= _tout) return _fail();
+            delay(1);
+        }
+        return false;
+    }
+};
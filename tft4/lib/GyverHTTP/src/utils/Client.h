@@ -0,0 +1,799 @@
+#pragma once
+#include <Arduino.h>
+#include <Client.h>
+
+#ifndef __AVR__
+#include <functional>
+#endif
+
+#include "HeadersParser.h"
+#include "Pool.h"
+#include "StreamReader.h"
+#include "Timing.h"
+#include "cfg.h"
+
+#ifdef GHTTP_DNS_API
+#if defined(ESP8266)
+#include <ESP8266WiFi.h>
+#else
+#include <WiFi.h>
+#endif
+#endif
+
+#define HC_DEF_TIMEOUT 2000     // таймаут по умолчанию
+#define HC_FLUSH_BLOCK 64       // блок очистки
+#define HC_BOUNDARY "----GyverHttpBoundary123454321"
+#define HC_FORM_PARTS 4         // частей в StreamForm
+#define HC_FORM_BLOCK 512       // блок отправки StreamForm
+
+// #define HC_USE_LOG Serial      // лог подключений и ошибок клиента
+
+#ifdef HC_USE_LOG
+#define HC_LOG(x) HC_USE_LOG.println(x)
+#else
+#define HC_LOG(x) do {} while (0)
+#endif
+
+namespace ghttp {
+
+class Client : public Print, private BodyObserver {
+   public:
+    // билдер form data
+    class FormData {
+        friend class Client;
+
+       public:
+        void add(const Text& name, const Text& filename, const Text& type, const Text& data) {
+            _head(name, filename, type, data.length());
+            data.addString(s);
+            _tail();
+        }
+
+        // добавить данные, которые печатают себя сами (например gson::string(Print&)) - сразу в тело,
+        // без промежуточной строки. len - длина данных для резерва, узнать можно пробным printTo в gson::Counter
+        void add(const Text& name, const Text& filename, const Text& type, const Printable& data, size_t len) {
+            _head(name, filename, type, len);
+            data.printTo(s);
+            _tail();
+        }
+
+       private:
+        // тело формы: Printable печатает в неё блоками
+        class Body : public su::PrintString {
+           public:
+            using su::PrintString::write;
+            size_t write(const uint8_t* buffer, size_t size) override {
+                return concat((const char*)buffer, size) ? size : 0;
+            }
+        };
+
+        Body s;
+        bool _first = true;
+        bool _end = false;
+        void clrf() {
+            s += "\r\n";
+        }
+        void _head(const Text& name, const Text& filename, const Text& type, size_t len) {
+            s.reserve(s.length() + sizeof(HC_BOUNDARY) + 64 + name.length() + filename.length() + type.length() + len);
+            if (_first) s += F("--" HC_BOUNDARY);
+            _first = false;
+            clrf();
+            s += F("Content-Disposition: form-data; name=\"");
+            name.addString(s);
+            s += '"';
+            if (filename.length()) {
+                s += F("; filename=\"");
+                filename.addString(s);
+                s += '"';
+            }
+            clrf();
+            if (type.length()) {
+                s += F("Content-Type: ");
+                type.addString(s);
+                clrf();
+            }
+            clrf();
+        }
+        void _tail() {
+            clrf();
+            s += F("--" HC_BOUNDARY);
+        }
+    };
+
+    // form data по ссылкам: части не копируются, а печатаются в сокет блоками HC_FORM_BLOCK при отправке.
+    // Данные частей должны жить до конца отправки. Stream читается один раз - для повтора его нужно
+    // перемотать (File::seek(0)) или добавить заново
+    class StreamForm : public Printable {
+        friend class Client;
+
+       public:
+        // текст (строка любого типа, в том числе PROGMEM)
+        bool add(const Text& name, const Text& filename, const Text& type, const Text& data) {
+            Part* p = _add(name, filename, type, Part::Kind::Text, data.length());
+            if (p) p->text = data;
+            return p;
+        }
+
+        // данные, которые печатают себя сами (например gson::string(Print&)). len - точная длина
+        bool add(const Text& name, const Text& filename, const Text& type, const Printable& data, size_t len) {
+            Part* p = _add(name, filename, type, Part::Kind::Print, len);
+            if (p) p->print = &data;
+            return p;
+        }
+
+        // len байт из потока (например File из LittleFS, len = file.size())
+        bool add(const Text& name, const Text& filename, const Text& type, Stream& data, size_t len) {
+            Part* p = _add(name, filename, type, Part::Kind::Stream, len);
+            if (p) p->stream = &data;
+            return p;
+        }
+
+        // удалить все части
+        void clear() {
+            _len = 0;
+        }
+
+        // длина тела запроса
+        size_t length() const {
+            if (!_len) return 0;
+            size_t len = 2 + _blen() + 2;  // --boundary ... --
+            for (uint8_t i = 0; i < _len; i++) len += _headLen(_parts[i]) + _parts[i].len + 2 + 2 + _blen();
+            return len;
+        }
+
+        // напечатать тело запроса
+        size_t printTo(Print& p) const {
+            if (!_len) return 0;
+            Block b(p);
+            b.print(F("--" HC_BOUNDARY));
+            for (uint8_t i = 0; i < _len; i++) {
+                const Part& part = _parts[i];
+                _head(b, part);
+                switch (part.kind) {
+                    case Part::Kind::Text:
+                        part.text.printTo(b);
+                        break;
+                    case Part::Kind::Print:
+                        part.print->printTo(b);
+                        break;
+                    case Part::Kind::Stream:
+                        if (!b.read(*part.stream, part.len)) return b.end();
+                        break;
+                }
+                b.print(F("\r\n--" HC_BOUNDARY));
+            }
+            b.print(F("--"));
+            return b.end();
+        }
+
+       private:
+        struct Part {
+            enum class Kind : uint8_t {
+                Text,
+                Print,
+                Stream,
+            };
+            Text name, filename, type;
+            Text text;
+            const Printable* print;
+            Stream* stream;
+            size_t len;
+            Kind kind;
+        };
+
+        // буфер отправки: в сокет уходят целые блоки
+        class Block : public Print {
+           public:
+            Block(Print& p) : _p(p) {}
+
+            size_t write(uint8_t data) {
+                _buf[_len++] = data;
+                if (_len == HC_FORM_BLOCK) _send();
+                return 1;
+            }
+            size_t write(const uint8_t* buffer, size_t size) {
+                size_t left = size;
+                while (left) {
+                    size_t n = min(left, (size_t)(HC_FORM_BLOCK - _len));
+                    memcpy(_buf + _len, buffer, n);
+                    _len += n;
+                    buffer += n;
+                    left -= n;
+                    if (_len == HC_FORM_BLOCK) _send();
+                }
+                return size;
+            }
+
+            // дочитать len байт из потока прямо в буфер
+            bool read(Stream& s, size_t len) {
+                while (len) {
+                    size_t n = s.readBytes(_buf + _len, min(len, (size_t)(HC_FORM_BLOCK - _len)));
+                    if (!n) return false;
+                    _len += n;
+                    len -= n;
+                    if (_len == HC_FORM_BLOCK) _send();
+                    GHTTP_ESP_YIELD();
+                }
+                return true;
+            }
+
+            // отправить остаток, вернуть сколько ушло всего
+            size_t end() {
+                if (_len) _send();
+                return _sent;
+            }
+
+           private:
+            Print& _p;
+            uint8_t _buf[HC_FORM_BLOCK];
+            size_t _len = 0;
+            size_t _sent = 0;
+
+            void _send() {
+                _sent += _p.write(_buf, _len);
+                _len = 0;
+            }
+        };
+
+        Part _parts[HC_FORM_PARTS];
+        uint8_t _len = 0;
+
+        Part* _add(const Text& name, const Text& filename, const Text& type, Part::Kind kind, size_t len) {
+            if (_len >= HC_FORM_PARTS) return nullptr;
+            Part& p = _parts[_len++];
+            p.name = name;
+            p.filename = filename;
+            p.type = type;
+            p.kind = kind;
+            p.len = len;
+            return &p;
+        }
+
+        static size_t _blen() {
+            return sizeof(HC_BOUNDARY) - 1;
+        }
+
+        // заголовок части, как у FormData
+        static void _head(Print& p, const Part& part) {
+            p.print(F("\r\nContent-Disposition: form-data; name=\""));
+            part.name.printTo(p);
+            p.print('"');
+            if (part.filename.length()) {
+                p.print(F("; filename=\""));
+                part.filename.printTo(p);
+                p.print('"');
+            }
+            p.print(F("\r\n"));
+            if (part.type.length()) {
+                p.print(F("Content-Type: "));
+                part.type.printTo(p);
+                p.print(F("\r\n"));
+            }
+            p.print(F("\r\n"));
+        }
+        static size_t _headLen(const Part& part) {
+            size_t len = strlen_P(PSTR("\r\nContent-Disposition: form-data; name=\"\"\r\n\r\n")) + part.name.length();
+            if (part.filename.length()) len += strlen_P(PSTR("; filename=\"\"")) + part.filename.length();
+            if (part.type.length()) len += strlen_P(PSTR("Content-Type: \r\n")) + part.type.length();
+            return len;
+        }
+    };
+
+    // билдер заголовков
+    class Headers {
+        friend class Client;
+
+       public:
+        void add(const Text& name, const Text& value) {
+            name.addString(headers);
+            headers += ": ";
+            value.addString(headers);
+            headers += "\r\n";
+        }
+
+        operator Text() {
+            return headers;
+        }
+
+       private:
+        String headers;
+    };
+
+    // парсер ответа
+    class Response {
+       public:
+        Response() {}
+        Response(const char* type, Stream* stream, size_t len, bool chunked, uint16_t code) : _reader(stream, len, chunked), _code(code) {
+            strlcpy(_type, type, GHTTP_TYPE_LEN);
+        }
+
+        // тип контента
+        Text type() const {
+            return Text(_type);
+        }
+
+        // тело ответа
+        StreamReader& body() {
+            return _reader;
+        }
+
+        // код ответа
+        uint16_t code() {
+            return _code;
+        }
+
+        // ответ существует
+        operator bool() {
+            return _reader;
+        }
+
+       private:
+        char _type[GHTTP_TYPE_LEN] = {};
+        StreamReader _reader;
+        uint16_t _code = 0;
+    };
+
+   private:
+#ifdef __AVR__
+    typedef void (*ResponseCallback)(Response& resp);
+#else
+    typedef std::function<void(Response& resp)> ResponseCallback;
+#endif
+
+   public:
+    Client(::Client& client, const char* host, uint16_t port) : _cl(&client), _host(host), _port(port) {
+        setTimeout(HC_DEF_TIMEOUT);
+    }
+    Client(::Client& client, const IPAddress& ip, uint16_t port) : _cl(&client), _host(nullptr), _ip(ip), _port(port) {
+        setTimeout(HC_DEF_TIMEOUT);
+    }
+
+    // клиент на сокетах из пула: при смене хоста соединение не закрывается, а возвращается в пул
+    Client(Pool& pool, const char* host, uint16_t port) : _cl(nullptr), _pool(&pool), _host(host), _port(port) {
+        setTimeout(HC_DEF_TIMEOUT);
+    }
+
+    size_t write(uint8_t data) {
+        if (!_connected()) {
+            _init();
+            return 0;
+        }
+        _sent();
+        return _traceOut(_cl->write(data));
+    }
+    size_t write(const uint8_t* buffer, size_t size) {
+        if (!_connected()) {
+            _init();
+            return 0;
+        }
+        _sent();
+        return _traceOut(_cl->write(buffer, size));
+    }
+
+    // ==========================
+
+    // установить новый хост и порт. Соединение из пула остаётся открытым для следующих запросов к старому хосту
+    void setHost(const char* host, uint16_t port) {
+        if (_pool && !isWaiting()) {
+            _release();
+            _init();
+        } else {
+            stop();
+        }
+        _host = host;
+        _port = port;
+    }
+
+    // установить новый хост и порт
+    void setHost(const IPAddress& ip, uint16_t port) {
+        setHost(nullptr, port);
+        _ip = ip;
+    }
+
+    // установить новый клиент для связи (вместо пула)
+    void setClient(::Client& client) {
+        stop();
+        _pool = nullptr;
+        _cl = &client;
+        _cl->setTimeout(_timeout);
+    }
+
+    // установить таймаут ответа сервера, умолч. 2000 мс
+    void setTimeout(uint16_t tout) {
+        if (_cl) _cl->setTimeout(tout);
+        _timeout = tout;
+    }
+
+    // просить сжатый ответ (Accept-Encoding: gzip, deflate), если собрано с GHTTP_INFLATE (умолч. вкл).
+    // Окно распаковки GHTTP_INFLATE_WINDOW меньше окна сервера, поэтому для больших ответов сжатие лучше выключить
+    void setAcceptEncoding(bool accept) {
+        _accept = accept;
+    }
+
+    // установить таймаут простоя: соединение, простоявшее дольше, переоткрывается перед запросом.
+    // 0 - без таймаута (умолч.), в пуле - таймаут пула. Keep-Alive: timeout от сервера сокращает его
+    void setIdleTimeout(uint32_t ms) {
+        _idle = ms;
+    }
+
+    // конвейер: следующий GET/HEAD отправляется, не дожидаясь чтения прошлого ответа (умолч. выкл).
+    // Ответы читаются getResponse() по порядку, тело каждого нужно дочитать до следующего getResponse()
+    void setPipelining(bool pipe) {
+        _pipe = pipe;
+    }
+
+    // запросов без прочитанного ответа
+    uint8_t pending() {
+        return isWaiting() ? _pending : 0;
+    }
+
+    // сокет текущего хоста (в пуле берётся при первом обращении), nullptr - все сокеты пула заняты.
+    // Например для настройки TLS перед connect()
+    ::Client* socket() {
+        if (!_cl && _pool) {
+            _cl = _pool->get(_host, _port);
+            if (_cl) _cl->setTimeout(_timeout);
+        }
+        return _cl;
+    }
+
+    // приёмник замеров запросов по фазам (например ghttp::Stats), nullptr - без замеров.
+    // При конвейере замеряется только первый запрос в очереди
+    void setHook(Hook* hook) {
+        _hook = hook;
+    }
+
+    // обработчик ответов, требует вызова tick() в loop()
+    void onResponse(ResponseCallback cb) {
+        _resp_cb = cb;
+    }
+
+    // ==========================
+
+    // соединение открыто. Простоявшее дольше таймаута закрывается
+    bool connected() {
+        if (!socket() || !_cl->connected()) return 0;
+        if (!_pending && _expired()) {
+            HC_LOG("idle timeout");
+            _cl->stop();
+            return 0;
+        }
+        return 1;
+    }
+
+    // подключиться. Соединение, простоявшее дольше таймаута, переоткрывается
+    bool connect() {
+        if (!socket()) return 0;
+        if (_hook && !_tstage) _traceOpen();
+        if (!connected()) {
+            HC_LOG("connect "+String(_host) + " "+ String(_port));
+            if (_tstage == 1) _traceConnect();
+            else _host ? _cl->connect(_host, _port) : _cl->connect(_ip, _port);
+            _active(0);
+        }
+        if (_cl->connected()) return 1;
+        if (_tstage == 1) _traceEnd(0);
+        return 0;
+    }
+
+    // отправить запрос
+    bool request(const Text& path, const Text& method, const Text& headers, FormData& data) {
+        // закрывающий "--" добавляется один раз, данные можно отправлять повторно
+        if (!data._end) data.s += "--";
+        data._end = true;
+        return request(path, method, headers, (uint8_t*)data.s.c_str(), data.s.length(), true);
+    }
+
+    // отправить запрос. Тело печатается блоками прямо в сокет, Content-Length известен заранее
+    bool request(const Text& path, const Text& method, const Text& headers, const StreamForm& data) {
+        size_t len = data.length();
+        if (!_begin(path, method, headers, len, true)) return 0;
+        return data.printTo(*this) == len;
+    }
+
+    // отправить запрос
+    bool request(const Text& path, const Text& method, const Text& headers, const Text& payload) {
+        return request(path, method, headers, (uint8_t*)payload.str(), payload.length());
+    }
+
+    // отправить запрос
+    bool request(const Text& path, const Text& method = "GET", const Text& headers = Text(), const uint8_t* payload = nullptr, size_t length = 0, bool formdata = 0) {
+        if (!payload) length = 0;
+        if (!_begin(path, method, headers, length, formdata)) return 0;
+        if (length) write(payload, length);
+        return 1;
+    }
+
+    // начать отправку. Дальше нужно вручную print
+    bool beginSend() {
+        return _beginSend(_pipe);
+    }
+
+    // клиент ждёт ответа
+    bool isWaiting() {
+        if (!_connected()) {
+            _init();
+            return 0;
+        }
+        return _pending;
+    }
+
+    // есть ответ от сервера (асинхронно)
+    bool available() {
+        return (isWaiting() && _cl->available());
+    }
+
+    // дождаться и прочитать ответ сервера (по available если long poll)
+    Response getResponse(HeadersCollector* collector = nullptr) {
+        if (!isWaiting()) return Response();
+
+        if (!_wait()) {
+            flush();
+            return Response();
+        }
+        _traceRecv();
+
+        HeadersParser headers(collector, true);
+        headers.read(*_cl);
+        if (_tstage == 3) _trace.in += headers.bytes;
+
+        if (headers) {
+            _close = headers.close;
+            _active(headers.keepAlive * 1000ul);
+            _pending--;
+            Response resp(headers.contentType, _cl, headers.length, headers.chunked, headers.code);
+#ifdef GHTTP_INFLATE
+            switch (headers.encoding) {
+                case HeadersParser::Encoding::Gzip:
+                case HeadersParser::Encoding::Deflate:
+                    if (!resp.body().inflate(headers.encoding == HeadersParser::Encoding::Gzip)) HC_LOG("inflate alloc error");
+                    break;
+                default:
+                    break;
+            }
+#endif
+            if (_tstage == 3) {
+                if (resp.body().available()) resp.body().observe(this, _seq);
+                else _traceEnd(!resp.body().error());
+            }
+            return resp;
+        } else {
+            HC_LOG("No headers");
+            flush();
+            return Response();
+        }
+    }
+
+    // тикер, вызывать в loop для работы с коллбэком
+    void tick() {
+        if (available() && _resp_cb) {
+            Response resp = getResponse();
+            if (resp) _resp_cb(resp);
+        }
+    }
+
+    // остановить клиента (сокет возвращается в пул закрытым)
+    void stop() {
+        HC_LOG("client stop");
+        _traceEnd(0);
+        if (_cl) _cl->stop();
+        _release();
+        _init();
+    }
+
+    // пропустить ответ (при конвейере - все), снять флаг ожидания, остановить если connection close
+    void flush() {
+        if (_tstage >= 2) _traceEnd(0);  // ответ не дочитан
+        if (_connected()) {
+            _wait();  // по таймауту stop() возвращает сокет в пул
+            uint8_t bytes[HC_FLUSH_BLOCK];
+            while (_connected() && _cl->available()) {
+                delay(1);
+                GHTTP_ESP_YIELD();
+                _cl->readBytes(bytes, min(_cl->available(), HC_FLUSH_BLOCK));
+            }
+            if (_close && _cl) {
+                HC_LOG("connection close");
+                _cl->stop();
+            }
+        }
+        _init();
+    }
+
+   private:
+    ::Client* _cl;
+    Pool* _pool = nullptr;
+    ResponseCallback _resp_cb = nullptr;
+    const char* _host = nullptr;
+    IPAddress _ip;
+    uint16_t _port;
+    uint16_t _timeout;
+    uint32_t _lastSend;
+    uint32_t _lastRecv = 0;   // соединение открыто или последний ответ (без пула, иначе в слоте пула)
+    uint32_t _idle = 0;       // таймаут простоя
+    uint32_t _keepAlive = 0;  // таймаут простоя от сервера (без пула)
+    bool _close = 0;
+    bool _pipe = 0;
+    bool _accept = 1;     // Accept-Encoding
+    bool _counted = 0;    // отправляемый запрос уже учтён в _pending
+    uint8_t _pending = 0;  // запросов без прочитанного ответа
+
+    // замеры
+    Hook* _hook = nullptr;
+    Trace _trace;
+    uint32_t _tmr = 0;     // начало текущей фазы
+    uint32_t _tlast = 0;   // последний байт замеряемого запроса
+    uint8_t _tstage = 0;   // 0 нет замера, 1 подключение, 2 отправка, 3 ответ
+    uint8_t _seq = 0;      // номер замера для StreamReader::observe
+    bool _tcount = 0;      // отправляется замеряемый запрос
+
+    bool _connected() {
+        return _cl && _cl->connected();
+    }
+
+    // соединение открыто или получен ответ. idle - таймаут простоя от сервера
+    void _active(uint32_t idle) {
+        if (_pool) {
+            _pool->active(_cl, idle);
+        } else {
+            _lastRecv = millis();
+            _keepAlive = idle;
+        }
+    }
+
+    // соединение простояло дольше таймаута. В пуле - таймауты слота, который сейчас у клиента
+    bool _expired() {
+        if (_pool) return _pool->expired(_cl);
+        uint32_t idle = _idle;
+        if (_keepAlive && (!idle || _keepAlive < idle)) idle = _keepAlive;
+        return idle && millis() - _lastRecv >= idle;
+    }
+
+    // вернуть сокет в пул
+    void _release() {
+        if (!_pool || !_cl) return;
+        _pool->release(_cl);
+        _cl = nullptr;
+    }
+
+    // pipe - не ждать прошлых ответов
+    bool _beginSend(bool pipe) {
+        if (!pipe || !_pending || _close) flush();
+        _counted = 0;
+        _tcount = 0;
+        return connect();
+    }
+
+    // отправка запроса: первый байт нового запроса - ещё один ожидаемый ответ
+    void _sent() {
+        if (!_counted) {
+            _counted = 1;
+            _pending++;
+            if (_tstage == 1) {
+                _trace.host = _host;
+                _tstage = 2;
+                _tcount = 1;
+                _tmr = millis();
+            }
+        }
+        _lastSend = millis();
+        if (_tcount) _tlast = _lastSend;
+    }
+
+    // отправить стартовую строку и заголовки. length - длина тела
+    bool _begin(const Text& path, const Text& method, const Text& headers, size_t length, bool formdata) {
+        if (!_beginSend(_pipe && (method == "GET" || method == "HEAD"))) return 0;
+
+        String req;
+        req.reserve(50 + path.length() + headers.length());
+        method.addString(req);
+        req += ' ';
+        path.addString(req);
+        req += F(" HTTP/1.1\r\nHost: ");
+        if (_host) req += _host;
+        else req += _ip.toString();
+        req += F("\r\n");
+#ifdef GHTTP_INFLATE
+        if (_accept) req += F("Accept-Encoding: gzip, deflate\r\n");
+#endif
+        headers.addString(req);
+        if (formdata) {
+            req += F("Content-Type: multipart/form-data; boundary=" HC_BOUNDARY "\r\n");
+        }
+        if (length) {
+            req += F("Content-Length: ");
+            req += length;
+            req += F("\r\n");
+        }
+        req += F("\r\n");
+        print(req);
+        return 1;
+    }
+
+    void _init() {
+        _close = 0;
+        _pending = 0;
+        _counted = 0;
+    }
+    bool _wait() {
+        if (!_pending) return 0;
+        while (!_cl->available()) {
+            delay(1);
+#ifdef ESP8266
+            optimistic_yield(5000);
+#endif
+            GHTTP_ESP_YIELD();
+
+            if (millis() - _lastSend >= _timeout) {
+                HC_LOG("client timeout");
+                stop();
+                return 0;
+            }
+            if (!_cl->connected()) {
+                HC_LOG("client disconnected");
+                return 0;
+            }
+        }
+        return 1;
+    }
+
+    // ==================== TRACE ====================
+    // новый замер с подключения, закрывается концом ответа. У открытого соединения фаз DNS и Connect нет
+    void _traceOpen() {
+        memset(&_trace, 0, sizeof(_trace));
+        _trace.host = _host;
+        _trace.reused = 1;
+        _tstage = 1;
+    }
+
+    // подключение с замером. Адрес берётся заранее, connect(host) находит его в кэше DNS
+    // и сам передаёт имя хоста для SNI
+    void _traceConnect() {
+        _trace.reused = 0;
+        uint32_t ms = millis();
+#ifdef GHTTP_DNS_API
+        if (_host) {
+            IPAddress ip;
+            WiFi.hostByName(_host, ip);
+            _trace.phase[(uint8_t)Phase::DNS] = millis() - ms;
+            ms = millis();
+        }
+#endif
+        _host ? _cl->connect(_host, _port) : _cl->connect(_ip, _port);
+        _trace.phase[(uint8_t)Phase::Connect] = millis() - ms;
+    }
+
+    size_t _traceOut(size_t n) {
+        if (_tcount) _trace.out += n;
+        return n;
+    }
+
+    // пришёл первый байт ответа
+    void _traceRecv() {
+        if (_tstage == 3) _traceEnd(0);  // тело прошлого ответа не дочитано
+        if (_tstage != 2) return;
+        _tcount = 0;
+        _tstage = 3;
+        _trace.phase[(uint8_t)Phase::Send] = _tlast - _tmr;
+        _tmr = millis();
+        _trace.phase[(uint8_t)Phase::TTFB] = _tmr - _tlast;
+    }
+
+    void bodyEnd(uint8_t seq, size_t len, bool ok) override {
+        if (_tstage != 3 || seq != _seq) return;
+        _trace.phase[(uint8_t)Phase::Body] = millis() - _tmr;
+        _trace.in += len;
+        _traceEnd(ok);
+    }
+
+    void _traceEnd(bool ok) {
+        if (!_tstage) return;
+        _tstage = 0;
+        _tcount = 0;
+        _seq++;
+        _trace.ok = ok;
+        if (_hook) _hook->trace(_trace);
+    }
+};
+
+}  // namespace ghttp
\ No newline at end of file
@@ -0,0 +1,267 @@
+#pragma once
+#include <Arduino.h>
+#include <StringUtils.h>
+
+// #define GHTTP_HEADERS_LOG Serial    // лог строк заголовков
+
+#ifndef GHTTP_HEADER_LEN
+#define GHTTP_HEADER_LEN 128  // буфер строки заголовка (имя и значение), длиннее - обрезается
+#endif
+
+#ifndef GHTTP_TYPE_LEN
+#define GHTTP_TYPE_LEN 48  // буфер Content-Type
+#endif
+
+#include "cfg.h"
+
+namespace ghttp {
+
+class HeadersCollector {
+   public:
+    virtual void header(Text& name, Text& value) = 0;
+};
+
+// разбор заголовков посимвольно в фиксированном буфере, без кучи.
+// Имя сравнивается по хэшу без учёта регистра (su::SH от имени в нижнем регистре), значение разбирается на месте
+class HeadersParser {
+   public:
+    // пустой парсер для разбора по символу через feed(). status - начать со стартовой строки ответа (HTTP/1.1 200 OK)
+    HeadersParser(HeadersCollector* collector = nullptr, bool status = false) : _collector(collector), _state(status ? State::Status : State::Name) {}
+
+    // прочитать заголовки из потока до пустой строки (с таймаутом потока)
+    template <typename client_t>
+    HeadersParser(client_t& client, HeadersCollector* collector = nullptr) : HeadersParser(collector) {
+        read(client);
+    }
+
+    // legacy
+    template <typename client_t>
+    HeadersParser(client_t& client, size_t, HeadersCollector* collector = nullptr) : HeadersParser(client, collector) {}
+
+    // прочитать из потока ровно до конца заголовков. Тело остаётся в потоке
+    template <typename client_t>
+    bool read(client_t& client) {
+        while (!done()) {
+#ifdef GHTTP_PEEK_API
+            // заголовки разбираются прямо из буфера TLS и снимаются из него ровно до конца
+            size_t n = client.peekAvailable();
+            if (n) {
+                const char* p = client.peekBuffer();
+                size_t i = 0;
+                while (i < n && !feed(p[i])) i++;
+                if (i < n) i++;
+                client.peekConsume(i);
+                bytes += i;
+                GHTTP_ESP_YIELD();
+                continue;
+            }
+#endif
+            char c;
+            if (client.readBytes(&c, 1) != 1) {
+#ifdef GHTTP_HEADERS_LOG
+                GHTTP_HEADERS_LOG.println(F("headers timeout"));
+#endif
+                _state = State::Error;
+                break;
+            }
+            bytes++;
+            feed(c);
+            if (c == '\n') GHTTP_ESP_YIELD();
+        }
+        return valid;
+    }
+
+    // разобрать символ. true - заголовки закончились (valid) или ошибка
+    bool feed(char c) {
+        switch (_state) {
+            case State::Done:
+            case State::Error:
+                return true;
+
+            case State::CR:
+                if (c != '\n') return _error();
+                _line();
+                break;
+
+            default:
+                if (c == '\r') {
+                    _prev = _state;
+                    _state = State::CR;
+                } else if (c == '\n') {
+                    return _error();  // строка должна оканчиваться на \r\n
+                } else {
+                    _char(c);
+                }
+                break;
+        }
+        return done();
+    }
+
+    // разбор закончен
+    bool done() const {
+        return _state == State::Done || _state == State::Error;
+    }
+
+    // Content-Encoding
+    enum class Encoding : uint8_t {
+        Identity,
+        Gzip,
+        Deflate,
+        Other,  // br, несколько кодировок и прочее
+    };
+
+    char contentType[GHTTP_TYPE_LEN] = {};
+    Encoding encoding = Encoding::Identity;
+    size_t length = 0;
+    size_t bytes = 0;        // байт прочитано read()
+    uint16_t code = 0;       // код ответа из стартовой строки
+    uint16_t keepAlive = 0;  // Keep-Alive: timeout, с (0 - не указан)
+    bool close = false;
+    bool valid = false;
+    bool chunked = false;
+
+    operator bool() {
+        return valid;
+    }
+
+   private:
+    enum class State : uint8_t {
+        Status,  // стартовая строка до кода
+        Code,    // код ответа
+        Reason,  // остаток стартовой строки
+        Name,
+        Value,
+        Skip,  // строка без двоеточия
+        CR,
+        Done,
+        Error,
+    };
+
+    HeadersCollector* _collector;
+    char _buf[GHTTP_HEADER_LEN];
+    size_t _hash = 0;
+    uint16_t _len = 0;    // символов в буфере
+    uint16_t _name = 0;   // длина имени в буфере
+    uint16_t _value = 0;  // начало значения в буфере
+    State _state;
+    State _prev = State::Name;
+
+    bool _error() {
+        _state = State::Error;
+        return true;
+    }
+
+    void _put(char c) {
+        if (_len < GHTTP_HEADER_LEN - 1) _buf[_len++] = c;
+    }
+
+    void _char(char c) {
+        switch (_state) {
+            case State::Status:
+                if (c == ' ') _state = State::Code;
+                break;
+
+            case State::Code:
+                if (c >= '0' && c <= '9') code = code * 10 + (c - '0');
+                else _state = State::Reason;
+                break;
+
+            case State::Name:
+                if (c == ':') {
+                    _name = _len;
+                    _value = _len;
+                    _state = _len ? State::Value : State::Skip;
+                    break;
+                }
+                _hash = _hash + (_hash << 5) + ((c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c);
+                _put(c);
+                break;
+
+            case State::Value:
+                if (_len == _value && (c == ' ' || c == '\t')) break;  // пробелы в начале значения
+                _put(c);
+                break;
+
+            default:
+                break;
+        }
+#ifdef GHTTP_HEADERS_LOG
+        if (_state == State::Status || _state == State::Code || _state == State::Reason) _put(c);
+#endif
+    }
+
+    // конец строки
+    void _line() {
+        switch (_prev) {
+            case State::Status:
+            case State::Code:
+            case State::Reason:
+#ifdef GHTTP_HEADERS_LOG
+                GHTTP_HEADERS_LOG.write((const uint8_t*)_buf, _len);
+                GHTTP_HEADERS_LOG.println();
+#endif
+                break;
+
+            case State::Name:
+                if (!_len) {  // пустая строка - конец заголовков
+                    valid = true;
+                    _state = State::Done;
+                    return;
+                }
+                break;
+
+            case State::Value:
+                while (_len > _value && (_buf[_len - 1] == ' ' || _buf[_len - 1] == '\t')) _len--;
+                _buf[_len] = 0;
+#ifdef GHTTP_HEADERS_LOG
+                GHTTP_HEADERS_LOG.write((const uint8_t*)_buf, _name);
+                GHTTP_HEADERS_LOG.print(F(": "));
+                GHTTP_HEADERS_LOG.println(_buf + _value);
+#endif
+                _header();
+                break;
+
+            default:
+                break;
+        }
+        _state = State::Name;
+        _hash = 0;
+        _len = 0;
+    }
+
+    void _header() {
+        const char* value = _buf + _value;
+        if (_collector) {
+            Text name(_buf, _name);
+            Text val(value, _len - _value);
+            _collector->header(name, val);
+        }
+
+        switch (_hash) {
+            case su::SH("content-type"):
+                strlcpy(contentType, value, GHTTP_TYPE_LEN);
+                break;
+            case su::SH("content-length"):
+                length = 0;
+                for (; *value >= '0' && *value <= '9'; value++) length = length * 10 + (*value - '0');
+                break;
+            case su::SH("transfer-encoding"):
+                chunked = !strcasecmp_P(value, PSTR("chunked"));
+                break;
+            case su::SH("content-encoding"):
+                if (!strcasecmp_P(value, PSTR("gzip")) || !strcasecmp_P(value, PSTR("x-gzip"))) encoding = Encoding::Gzip;
+                else if (!strcasecmp_P(value, PSTR("deflate"))) encoding = Encoding::Deflate;
+                else if (strcasecmp_P(value, PSTR("identity"))) encoding = Encoding::Other;
+                break;
+            case su::SH("connection"):
+                close = !strcasecmp_P(value, PSTR("close"));
+                break;
+            case su::SH("keep-alive"): {
+                const char* tout = strstr_P(value, PSTR("timeout="));
+                if (tout) keepAlive = atoi(tout + 8);
+            } break;
+        }
+    }
+};
+
+}  // namespace ghttp
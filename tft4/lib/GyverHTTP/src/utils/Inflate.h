@@ -0,0 +1,488 @@
+#pragma once
+#include <Arduino.h>
+
+#include "cfg.h"
+
+#ifndef GHTTP_INFLATE_WINDOW
+#define GHTTP_INFLATE_WINDOW 8192  // окно распаковки, степень двойки. Ссылка дальше окна - ошибка
+#endif
+
+#define GHTTP_INFLATE_IN 64  // буфер сжатых данных
+
+namespace ghttp {
+
+// потоковая распаковка deflate (RFC 1951) в обёртке gzip (RFC 1952), zlib (RFC 1950) или без неё.
+// Сжатые данные подаются порциями в буфер tail()/fill(), распакованные читаются порциями через read().
+// Разбор останавливается на границе символа, если входа не хватает, и продолжается со следующей порции.
+// В памяти только окно GHTTP_INFLATE_WINDOW и таблицы (~1 КБ): сервер обычно сжимает с окном 32 КБ,
+// поэтому тело длиннее окна может сослаться дальше него - тогда error(), а не мусор на выходе
+class Inflate {
+   public:
+    // gzip - обёртка gzip, иначе zlib или голый deflate (определяется по заголовку)
+    Inflate(bool gzip) : _gzip(gzip), _state(gzip ? State::Gzip : State::Zlib) {
+        _win = new uint8_t[GHTTP_INFLATE_WINDOW];
+        if (!_win) _state = State::Error;
+        _lt.sym = _lsym;
+        _dt.sym = _dsym;
+    }
+
+    ~Inflate() {
+        delete[] _win;
+    }
+
+    Inflate(const Inflate&) = delete;
+    Inflate& operator=(const Inflate&) = delete;
+
+    // место для сжатых данных. Сдвигает непрочитанный остаток в начало буфера
+    size_t reserve() {
+        if (_inPos) {
+            memmove(_in, _in + _inPos, _inLen - _inPos);
+            _inLen -= _inPos;
+            _inPos = 0;
+        }
+        return GHTTP_INFLATE_IN - _inLen;
+    }
+
+    // куда писать сжатые данные (не больше reserve())
+    uint8_t* tail() {
+        return _in + _inLen;
+    }
+
+    // записано len байт в tail()
+    void fill(size_t len) {
+        _inLen += len;
+    }
+
+    // распаковать до len байт в buf. last - сжатых данных больше не будет.
+    // 0 - нужен вход, распаковка закончена или ошибка
+    size_t read(uint8_t* buf, size_t len, bool last) {
+        _last = last;
+        _out = buf;
+        _outLen = len;
+        _outPos = _sumPos = 0;
+        while (_outPos < _outLen && _step()) {
+        }
+        _checksum();
+        return _outPos;
+    }
+
+    // распаковка закончена, контрольная сумма совпала
+    bool done() const {
+        return _state == State::Done;
+    }
+
+    // ошибка формата, контрольной суммы, окна или нехватка памяти
+    bool error() const {
+        return _state == State::Error;
+    }
+
+   private:
+    enum class State : uint8_t {
+        Gzip,      // заголовок gzip
+        GzipSkip,  // FEXTRA, FNAME, FCOMMENT, FHCRC
+        Zlib,      // заголовок zlib или голый deflate
+        Block,     // заголовок блока
+        Stored,    // LEN NLEN несжатого блока
+        Copy,      // данные несжатого блока
+        Table,     // HLIT HDIST HCLEN
+        CodeLens,  // длины кодов длин
+        Lens,      // длины кодов литералов и дистанций
+        Sym,       // литерал или длина
+        LenExtra,
+        Dist,
+        DistExtra,
+        Match,  // копирование из окна
+        Trailer,
+        Done,
+        Error,
+    };
+
+    // канонический код Хаффмана: количество кодов каждой длины и символы по порядку кодов
+    struct Tree {
+        uint16_t count[16];
+        uint16_t* sym;
+    };
+
+    uint8_t* _win;
+    uint8_t* _out = nullptr;
+    size_t _outLen = 0;
+    size_t _outPos = 0;
+    size_t _sumPos = 0;  // выход, учтённый в _sum
+    uint32_t _total = 0;  // распаковано всего
+    uint32_t _sum = 0;    // crc32 или adler32
+    uint32_t _bits = 0;   // биты входа, младший - следующий
+    uint8_t _nbits = 0;
+    uint8_t _pad = 0;  // нулевых бит дописано после конца входа
+    uint8_t _in[GHTTP_INFLATE_IN];
+    uint8_t _inPos = 0, _inLen = 0;
+    uint16_t _wpos = 0;  // позиция записи в окне
+    uint16_t _len = 0;   // длина копирования
+    uint16_t _dist = 0;
+    uint16_t _i = 0;  // счётчик в заголовках
+    uint16_t _hlit = 0, _hdist = 0, _hclen = 0;
+    uint8_t _flags = 0;  // флаги gzip
+    bool _final = false;
+    bool _last = false;
+    bool _gzip;
+    bool _zlib = false;
+    State _state;
+
+    Tree _lt, _dt;
+    uint16_t _lsym[288];
+    uint16_t _dsym[32];
+    uint8_t _lens[288 + 32];
+
+    static constexpr uint16_t _lbase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static constexpr uint8_t _lextra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static constexpr uint16_t _dbase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    static constexpr uint8_t _dextra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+    static constexpr uint8_t _clorder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+    bool _error() {
+        _state = State::Error;
+        return false;
+    }
+
+    // ================= BITS =================
+
+    // набрать n бит (n <= 24, 32 - только на границе байта). После конца входа добираются нулями - их расход будет ошибкой в _drop
+    bool _need(uint8_t n) {
+        while (_nbits < n) {
+            if (_inPos < _inLen) {
+                _bits |= (uint32_t)_in[_inPos++] << _nbits;
+            } else if (_last) {
+                _pad += 8;
+            } else {
+                return false;
+            }
+            _nbits += 8;
+        }
+        return true;
+    }
+
+    bool _drop(uint8_t n) {
+        _bits >>= n;
+        _nbits -= n;
+        if (_nbits < _pad) return _error();  // вход кончился посреди данных
+        return true;
+    }
+
+    // снять n бит (после _need)
+    uint16_t _take(uint8_t n) {
+        uint16_t v = _bits & ((1ul << n) - 1);
+        _drop(n);
+        return v;
+    }
+
+    // байт после выравнивания, -1 - нужен вход
+    int _byte() {
+        if (!_need(8)) return -1;
+        return _take(8);
+    }
+
+    // символ по коду Хаффмана (после _need(15)). -1 - ошибка
+    int _decode(const Tree& t) {
+        int code = 0, first = 0, index = 0;
+        for (uint8_t len = 1; len < 16; len++) {
+            code |= (_bits >> (len - 1)) & 1;
+            int count = t.count[len];
+            if (code - first < count) {
+                if (!_drop(len)) return -1;
+                return t.sym[index + code - first];
+            }
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        _error();
+        return -1;
+    }
+
+    // построить код из длин. false - код переполнен
+    bool _build(Tree& t, const uint8_t* lens, uint16_t num) {
+        uint16_t offs[16];
+        memset(t.count, 0, sizeof(t.count));
+        for (uint16_t i = 0; i < num; i++) t.count[lens[i]]++;
+        t.count[0] = 0;
+        int left = 1;
+        offs[1] = 0;
+        for (uint8_t len = 1; len < 16; len++) {
+            left = (left << 1) - t.count[len];
+            if (left < 0) return false;
+            if (len < 15) offs[len + 1] = offs[len] + t.count[len];
+        }
+        for (uint16_t i = 0; i < num; i++) {
+            if (lens[i]) t.sym[offs[lens[i]]++] = i;
+        }
+        return true;
+    }
+
+    // ================= OUTPUT =================
+
+    void _put(uint8_t b) {
+        _win[_wpos] = b;
+        _wpos = (_wpos + 1) & (GHTTP_INFLATE_WINDOW - 1);
+        _out[_outPos++] = b;
+        _total++;
+    }
+
+    // учесть новый выход в контрольной сумме
+    void _checksum() {
+        if (_gzip) _crc32(_out + _sumPos, _outPos - _sumPos);
+        else _adler32(_out + _sumPos, _outPos - _sumPos);
+        _sumPos = _outPos;
+    }
+
+    void _crc32(const uint8_t* buf, size_t len) {
+        static const uint32_t table[16] = {
+            0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+            0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c};
+        uint32_t crc = ~_sum;
+        while (len--) {
+            crc ^= *buf++;
+            crc = (crc >> 4) ^ table[crc & 15];
+            crc = (crc >> 4) ^ table[crc & 15];
+        }
+        _sum = ~crc;
+    }
+
+    void _adler32(const uint8_t* buf, size_t len) {
+        uint32_t a = (_sum & 0xffff), b = _sum >> 16;
+        while (len--) {
+            a = (a + *buf++) % 65521;
+            b = (b + a) % 65521;
+        }
+        _sum = (b << 16) | a;
+    }
+
+    // ================= STATES =================
+
+    // один шаг разбора. false - нужен вход, конец или ошибка
+    bool _step() {
+        switch (_state) {
+            case State::Gzip:
+                // ID1 ID2 CM FLG MTIME(4) XFL OS
+                while (_i < 10) {
+                    int c = _byte();
+                    if (c < 0 || error()) return false;
+                    if ((_i == 0 && c != 0x1f) || (_i == 1 && c != 0x8b) || (_i == 2 && c != 8)) return _error();
+                    if (_i == 3) _flags = c;
+                    _i++;
+                }
+                _i = 0;
+                _state = State::GzipSkip;
+                return true;
+
+            case State::GzipSkip:
+                while (_flags & 0x1e) {
+                    int c = _byte();
+                    if (c < 0 || error()) return false;
+                    if (_flags & 0x04) {  // FEXTRA: длина (2) и данные
+                        if (_i < 2) _len |= c << (8 * _i);
+                        if (++_i >= 2 && _i - 2 >= _len) {
+                            _flags &= ~0x04;
+                            _i = _len = 0;
+                        }
+                    } else if (_flags & 0x08) {  // FNAME
+                        if (!c) _flags &= ~0x08;
+                    } else if (_flags & 0x10) {  // FCOMMENT
+                        if (!c) _flags &= ~0x10;
+                    } else if (++_i == 2) {  // FHCRC
+                        _flags &= ~0x02;
+                        _i = 0;
+                    }
+                }
+                _state = State::Block;
+                return true;
+
+            case State::Zlib:
+                // CMF FLG, иначе голый deflate
+                if (!_need(16)) return false;
+                _sum = 1;
+                if ((_bits & 0x0f) == 8 && ((_bits & 0xff) << 8 | ((_bits >> 8) & 0xff)) % 31 == 0 && !(_bits & 0x2000)) {
+                    _zlib = true;
+                    if (!_drop(16)) return false;
+                }
+                _state = State::Block;
+                return true;
+
+            case State::Block:
+                if (!_need(3)) return false;
+                _final = _take(1);
+                switch (_take(2)) {
+                    case 0:
+                        _drop(_nbits & 7);
+                        _state = State::Stored;
+                        break;
+                    case 1:
+                        _fixed();
+                        _state = State::Sym;
+                        break;
+                    case 2:
+                        _state = State::Table;
+                        break;
+                    default:
+                        return _error();
+                }
+                return !error();
+
+            case State::Stored:
+                if (!_need(32)) return false;  // после выравнивания в _bits только целые байты
+                _len = _take(16);
+                if ((_take(16) ^ _len) != 0xffff) return _error();
+                _state = _len ? State::Copy : _blockEnd();
+                return !error();
+
+            case State::Copy:
+                while (_len && _outPos < _outLen) {
+                    int c = _byte();
+                    if (c < 0 || error()) return false;
+                    _put(c);
+                    _len--;
+                }
+                if (!_len) _state = _blockEnd();
+                return true;
+
+            case State::Table:
+                if (!_need(14)) return false;
+                _hlit = _take(5) + 257;
+                _hdist = _take(5) + 1;
+                _hclen = _take(4) + 4;
+                if (_hlit > 286 || _hdist > 30) return _error();
+                memset(_lens, 0, 19);
+                _i = 0;
+                _state = State::CodeLens;
+                return true;
+
+            case State::CodeLens:
+                while (_i < _hclen) {
+                    if (!_need(3)) return false;
+                    _lens[_clorder[_i++]] = _take(3);
+                }
+                // код длин строится во временном дереве дистанций
+                if (!_build(_dt, _lens, 19)) return _error();
+                _i = 0;
+                _state = State::Lens;
+                return true;
+
+            case State::Lens:
+                while (_i < _hlit + _hdist) {
+                    if (!_need(14)) return false;  // код до 7 бит и повтор до 7 бит
+                    int sym = _decode(_dt);
+                    if (sym < 0) return false;
+                    uint8_t val = 0, rep = 1;
+                    switch (sym) {
+                        case 16:
+                            if (!_i) return _error();
+                            val = _lens[_i - 1];
+                            rep = 3 + _take(2);
+                            break;
+                        case 17:
+                            rep = 3 + _take(3);
+                            break;
+                        case 18:
+                            rep = 11 + _take(7);
+                            break;
+                        default:
+                            val = sym;
+                            break;
+                    }
+                    if (error() || _i + rep > _hlit + _hdist) return _error();
+                    while (rep--) _lens[_i++] = val;
+                }
+                if (!_lens[256]) return _error();  // нет конца блока
+                if (!_build(_lt, _lens, _hlit) || !_build(_dt, _lens + _hlit, _hdist)) return _error();
+                _state = State::Sym;
+                return true;
+
+            case State::Sym: {
+                if (!_need(15)) return false;
+                int sym = _decode(_lt);
+                if (sym < 0) return false;
+                if (sym < 256) {
+                    _put(sym);
+                } else if (sym == 256) {
+                    _state = _blockEnd();
+                } else {
+                    sym -= 257;
+                    if (sym >= 29) return _error();
+                    _len = sym;
+                    _state = State::LenExtra;
+                }
+                return true;
+            }
+
+            case State::LenExtra:
+                if (!_need(_lextra[_len])) return false;
+                _len = _lbase[_len] + _take(_lextra[_len]);
+                _state = State::Dist;
+                return !error();
+
+            case State::Dist: {
+                if (!_need(15)) return false;
+                int sym = _decode(_dt);
+                if (sym < 0) return false;
+                if (sym >= 30) return _error();
+                _dist = sym;
+                _state = State::DistExtra;
+                return true;
+            }
+
+            case State::DistExtra: {
+                if (!_need(_dextra[_dist])) return false;
+                uint32_t dist = _dbase[_dist] + _take(_dextra[_dist]);
+                if (error()) return false;
+                if (dist > GHTTP_INFLATE_WINDOW || dist > _total) return _error();  // дальше окна или начала
+                _dist = dist;
+                _state = State::Match;
+                return true;
+            }
+
+            case State::Match:
+                while (_len && _outPos < _outLen) {
+                    _put(_win[(_wpos - _dist) & (GHTTP_INFLATE_WINDOW - 1)]);
+                    _len--;
+                }
+                if (!_len) _state = State::Sym;
+                return true;
+
+            case State::Trailer:
+                // gzip: CRC32 и ISIZE (LE), zlib: adler32 (BE)
+                _checksum();
+                while (_i < (_gzip ? 8 : (_zlib ? 4 : 0))) {
+                    int c = _byte();
+                    if (c < 0 || error()) return false;
+                    uint32_t v = _gzip ? (_i < 4 ? _sum : _total) : _sum;
+                    uint8_t n = _gzip ? (_i & 3) : (3 - _i);
+                    if (((v >> (8 * n)) & 0xff) != (uint8_t)c) return _error();
+                    _i++;
+                }
+                _state = State::Done;
+                return false;
+
+            default:
+                return false;
+        }
+    }
+
+    // конец блока: следующий блок или хвост после последнего
+    State _blockEnd() {
+        if (!_final) return State::Block;
+        _drop(_nbits & 7);
+        _i = 0;
+        return State::Trailer;
+    }
+
+    void _fixed() {
+        uint16_t i = 0;
+        for (; i < 144; i++) _lens[i] = 8;
+        for (; i < 256; i++) _lens[i] = 9;
+        for (; i < 280; i++) _lens[i] = 7;
+        for (; i < 288; i++) _lens[i] = 8;
+        for (i = 0; i < 30; i++) _lens[288 + i] = 5;
+        _build(_lt, _lens, 288);
+        _build(_dt, _lens + 288, 30);
+    }
+};
+
+}  // namespace ghttp
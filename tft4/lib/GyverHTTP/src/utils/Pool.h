@@ -0,0 +1,147 @@
+#pragma once
+#include <Arduino.h>
+#include <Client.h>
+
+#include "cfg.h"
+
+#ifndef GHTTP_POOL_SIZE
+#define GHTTP_POOL_SIZE 2  // сокетов в пуле
+#endif
+
+#define GHTTP_POOL_IDLE 60000  // таймаут простоя соединения по умолчанию, мс
+
+namespace ghttp {
+
+// пул открытых соединений по (хост, порт) для ghttp::Client.
+// Сокеты создаёт программа и добавляет в пул: на ESP8266 каждое соединение TLS - это несколько КБ буферов,
+// там обычно хватает памяти только на один. Соединение, простоявшее дольше таймаута, закрывается:
+// сервер к этому времени мог закрыть его сам, и запрос по нему ушёл бы в пустоту
+class Pool {
+   public:
+    Pool() {}
+
+    // пул из массива сокетов
+    template <typename client_t, size_t N>
+    Pool(client_t (&clients)[N]) {
+        for (size_t i = 0; i < N; i++) add(clients[i]);
+    }
+
+    // добавить сокет
+    bool add(::Client& client) {
+        if (_len >= GHTTP_POOL_SIZE) return false;
+        _slots[_len++].client = &client;
+        return true;
+    }
+
+    // сокетов в пуле
+    uint8_t size() const {
+        return _len;
+    }
+
+    // установить таймаут простоя соединения, умолч. GHTTP_POOL_IDLE мс. 0 - только Keep-Alive: timeout от сервера
+    void setIdleTimeout(uint32_t ms) {
+        _idle = ms;
+    }
+
+    // таймаут простоя, мс
+    uint32_t idleTimeout() const {
+        return _idle;
+    }
+
+    // взять сокет для host:port: открытый к этому хосту, иначе закрытый, иначе дольше всех простаивающий
+    // (его соединение закрывается). nullptr - все сокеты заняты
+    ::Client* get(const char* host, uint16_t port) {
+        tick();
+        Slot* slot = nullptr;
+        for (uint8_t i = 0; i < _len; i++) {
+            Slot& s = _slots[i];
+            if (s.busy) continue;
+            if (s.host && s.port == port && !strcmp(s.host, host) && s.client->connected()) {
+                slot = &s;
+                break;
+            }
+            if (!slot || _spare(s, *slot)) slot = &s;
+        }
+        if (!slot) return nullptr;
+        if (!slot->host || slot->port != port || strcmp(slot->host, host)) {
+            if (slot->client->connected()) slot->client->stop();
+            slot->host = host;
+            slot->port = port;
+        }
+        slot->busy = true;
+        return slot->client;
+    }
+
+    // вернуть сокет. Открытое соединение остаётся для следующего запроса к тому же хосту
+    void release(::Client* client) {
+        Slot* s = _find(client);
+        if (s) s->busy = false;
+    }
+
+    // соединение сокета открыто или получен ответ: простой отсчитывается заново.
+    // idle - таймаут простоя от сервера (Keep-Alive: timeout), 0 - таймаут пула
+    void active(::Client* client, uint32_t idle = 0) {
+        Slot* s = _find(client);
+        if (!s) return;
+        s->last = millis();
+        s->keepAlive = idle;
+    }
+
+    // соединение сокета простояло дольше таймаута (своего: от сервера или пула)
+    bool expired(::Client* client) {
+        Slot* s = _find(client);
+        return s && _expired(*s);
+    }
+
+    // закрыть соединения, простоявшие дольше таймаута. Вызывается в get(), можно вызывать в loop
+    void tick() {
+        for (uint8_t i = 0; i < _len; i++) {
+            Slot& s = _slots[i];
+            if (!s.busy && _expired(s) && s.client->connected()) s.client->stop();
+        }
+    }
+
+    // закрыть все соединения
+    void stop() {
+        for (uint8_t i = 0; i < _len; i++) {
+            _slots[i].client->stop();
+            _slots[i].host = nullptr;
+        }
+    }
+
+   private:
+    struct Slot {
+        ::Client* client = nullptr;
+        const char* host = nullptr;
+        uint32_t last = 0;       // соединение открыто или последний ответ
+        uint32_t keepAlive = 0;  // таймаут простоя от сервера
+        uint16_t port = 0;
+        bool busy = false;
+    };
+
+    Slot _slots[GHTTP_POOL_SIZE];
+    uint32_t _idle = GHTTP_POOL_IDLE;
+    uint8_t _len = 0;
+
+    // a лучше b для нового соединения: закрытый, иначе дольше простаивающий
+    static bool _spare(const Slot& a, const Slot& b) {
+        bool ac = a.client->connected(), bc = b.client->connected();
+        if (ac != bc) return !ac;
+        return (int32_t)(a.last - b.last) < 0;
+    }
+
+    bool _expired(const Slot& s) const {
+        uint32_t idle = _idle;
+        if (s.keepAlive && (!idle || s.keepAlive < idle)) idle = s.keepAlive;
+        return s.host && idle && millis() - s.last >= idle;
+    }
+
+    Slot* _find(::Client* client) {
+        for (uint8_t i = 0; i < _len; i++) {
+            if (_slots[i].client == client) return &_slots[i];
+        }
+        return nullptr;
+    }
+};
+
+}  // namespace ghttp
@@ -0,0 +1,193 @@
+#pragma once
+#include <Arduino.h>
+#include <Print.h>
+
+#ifndef GHTTP_STATS_HOSTS
+#define GHTTP_STATS_HOSTS 4  // хостов в ghttp::Stats, при переполнении - в последний слот
+#endif
+
+#define GHTTP_STATS_BUCKETS 10  // корзин гистограммы (границы в Stats::edge)
+#define GHTTP_PHASES 5
+
+namespace ghttp {
+
+// фазы запроса ghttp::Client, мс
+enum class Phase : uint8_t {
+    DNS,      // WiFi.hostByName (только ESP, в остальном входит в Connect)
+    Connect,  // ::Client::connect: TCP и рукопожатие TLS одним вызовом
+    Send,     // от первого до последнего байта запроса
+    TTFB,     // от конца запроса до первого байта ответа
+    Body,     // от первого байта ответа до конца тела (с заголовками)
+};
+
+// замер одного запроса. Фазы, которых не было (открытое соединение), - 0
+struct Trace {
+    const char* host;  // указатель хоста клиента, nullptr - подключение по IP
+    uint32_t phase[GHTTP_PHASES];
+    uint32_t out;  // байт отправлено
+    uint32_t in;   // байт принято: заголовки и тело до распаковки, без разметки chunked
+    bool reused;   // соединение уже было открыто
+    bool ok;       // ответ прочитан до конца
+};
+
+// приёмник замеров ghttp::Client::setHook(). Без приёмника клиент только проверяет указатель
+class Hook {
+   public:
+    // запрос закончен: тело прочитано до конца, ошибка или обрыв
+    virtual void trace(const Trace& t) = 0;
+};
+
+// конец тела ответа для замеров клиента (StreamReader -> Client)
+class BodyObserver {
+   public:
+    // seq - номер запроса, len - байт тела как пришло
+    virtual void bodyEnd(uint8_t seq, size_t len, bool ok) = 0;
+};
+
+// гистограммы фаз по хостам с фиксированными корзинами
+class Stats : public Hook, public Printable {
+   public:
+    struct Hist {
+        uint16_t count[GHTTP_STATS_BUCKETS];
+        uint32_t sum;
+        uint32_t max;
+        uint16_t n;
+
+        void add(uint32_t ms) {
+            uint8_t i = 0;
+            while (i < GHTTP_STATS_BUCKETS - 1 && ms >= edge(i)) i++;
+            if (count[i] < UINT16_MAX) count[i]++;
+            if (n < UINT16_MAX) n++;
+            sum += ms;
+            if (ms > max) max = ms;
+        }
+
+        // среднее, мс
+        uint32_t avg() const {
+            return n ? sum / n : 0;
+        }
+
+        // оценка процентиля p (0..100): верхняя граница корзины, куда попал p-й процент (в последней - max)
+        uint32_t percentile(uint8_t p) const {
+            uint32_t need = ((uint32_t)n * p + 99) / 100, acc = 0;
+            for (uint8_t i = 0; i < GHTTP_STATS_BUCKETS - 1; i++) {
+                acc += count[i];
+                if (acc && acc >= need) return min(edge(i), max);
+            }
+            return max;
+        }
+    };
+
+    struct Host {
+        const char* host;  // nullptr в последнем слоте - несколько хостов
+        uint16_t requests;
+        uint16_t fails;
+        uint16_t reused;
+        uint32_t out;
+        uint32_t in;
+        Hist phase[GHTTP_PHASES];
+
+        const Hist& operator[](Phase p) const {
+            return phase[(uint8_t)p];
+        }
+    };
+
+    Stats() {
+        reset();
+    }
+
+    void trace(const Trace& t) override {
+        Host* h = _slot(t.host);
+        if (h->requests < UINT16_MAX) h->requests++;
+        if (!t.ok && h->fails < UINT16_MAX) h->fails++;
+        if (t.reused && h->reused < UINT16_MAX) h->reused++;
+        h->out += t.out;
+        h->in += t.in;
+        for (uint8_t i = 0; i < GHTTP_PHASES; i++) {
+            // фаз соединения у открытого соединения не было
+            if (t.reused && i <= (uint8_t)Phase::Connect) continue;
+            h->phase[i].add(t.phase[i]);
+        }
+    }
+
+    // хостов с замерами
+    uint8_t size() const {
+        return _len;
+    }
+
+    const Host& operator[](uint8_t i) const {
+        return _hosts[i < GHTTP_STATS_HOSTS ? i : 0];
+    }
+
+    // замеры хоста, nullptr - нет
+    const Host* find(const char* host) const {
+        for (uint8_t i = 0; i < _len; i++) {
+            if (_hosts[i].host && host && !strcmp(_hosts[i].host, host)) return &_hosts[i];
+        }
+        return nullptr;
+    }
+
+    void reset() {
+        memset(_hosts, 0, sizeof(_hosts));
+        _len = 0;
+    }
+
+    // верхняя граница корзины i, мс (последняя корзина без границы)
+    static uint32_t edge(uint8_t i) {
+        static const uint16_t edges[GHTTP_STATS_BUCKETS - 1] = {10, 20, 50, 100, 200, 500, 1000, 2000, 5000};
+        return i < GHTTP_STATS_BUCKETS - 1 ? edges[i] : UINT32_MAX;
+    }
+
+    static const __FlashStringHelper* name(Phase p) {
+        switch (p) {
+            case Phase::DNS: return F("dns");
+            case Phase::Connect: return F("connect");
+            case Phase::Send: return F("send");
+            case Phase::TTFB: return F("ttfb");
+            case Phase::Body: return F("body");
+        }
+        return F("");
+    }
+
+    // таблица в Print (Serial.print(stats))
+    size_t printTo(Print& p) const override {
+        size_t s = 0;
+        for (uint8_t h = 0; h < _len; h++) {
+            const Host& host = _hosts[h];
+            s += p.print(host.host ? host.host : "(other)");
+            s += p.printf(": %u req, %u fail, %u reused, out %lu B, in %lu B\r\n", host.requests, host.fails, host.reused, (unsigned long)host.out, (unsigned long)host.in);
+            s += p.print(F("  phase        n   avg   p50   p90   max |"));
+            for (uint8_t i = 0; i < GHTTP_STATS_BUCKETS - 1; i++) s += p.printf(" <%-4u", (unsigned)edge(i));
+            s += p.println(F(" more"));
+            for (uint8_t i = 0; i < GHTTP_PHASES; i++) {
+                const Hist& hist = host.phase[i];
+                s += p.print(F("  "));
+                s += p.print(name((Phase)i));
+                for (uint8_t k = strlen_P((PGM_P)name((Phase)i)); k < 8; k++) s += p.write(' ');
+                s += p.printf(" %5u %5lu %5lu %5lu %5lu |", hist.n, (unsigned long)hist.avg(), (unsigned long)hist.percentile(50), (unsigned long)hist.percentile(90), (unsigned long)hist.max);
+                for (uint8_t b = 0; b < GHTTP_STATS_BUCKETS; b++) s += p.printf(" %5u", hist.count[b]);
+                s += p.println();
+            }
+        }
+        return s;
+    }
+
+   private:
+    Host _hosts[GHTTP_STATS_HOSTS];
+    uint8_t _len = 0;
+
+    Host* _slot(const char* host) {
+        for (uint8_t i = 0; i < _len; i++) {
+            if (_hosts[i].host == host || (_hosts[i].host && host && !strcmp(_hosts[i].host, host))) return &_hosts[i];
+        }
+        if (_len < GHTTP_STATS_HOSTS) {
+            _hosts[_len].host = host;
+            return &_hosts[_len++];
+        }
+        Host* last = &_hosts[GHTTP_STATS_HOSTS - 1];
+        last->host = nullptr;
+        return last;
+    }
+};
+
+}  // namespace ghttp
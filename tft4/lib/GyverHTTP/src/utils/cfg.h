@@ -0,0 +1,16 @@
+#pragma once
+
+#ifdef ESP8266
+#define GHTTP_ESP_YIELD() delay(0);//esp_yield();//optimistic_yield(2000);
+#else
+#define GHTTP_ESP_YIELD() do {} while (0)
+#endif
+
+// peek buffer API потока (ядро ESP8266 3.x): чтение без копирования
+#if defined(ESP8266) || defined(STREAM_PEEK_API)
+#define GHTTP_PEEK_API
+#endif
+
+// GHTTP_DNS_API (ESP8266/ESP32, задавать в флагах сборки): замер DNS отдельно от подключения через
+// WiFi.hostByName перед connect(). По умолчанию выключен - лишний вызов DNS на каждое подключение,
+// фаза DNS тогда 0 и входит в Connect
@@ -5,12 +5,36 @@
 #define FUSION_PORT 443
 #define PROXY_HOST "cs2.mmatvei.ru"
 #define PROXY_PORT 8000
-#define FUSION_PERIOD 6000
+#define FUSION_ETA 20             // ожидаемая длительность генерации без истории, с
+#define FUSION_ETA_HISTORY 5      // длительностей генерации в истории на (ширина, высота, стиль)
+#define FUSION_ETA_EARLY 2000     // первый опрос раньше ожидаемого окончания, мс
+#define FUSION_ETA_WINDOW 10000   // частый опрос после ожидаемого окончания, мс
+#define FUSION_POLL_MIN 2000      // период частого опроса, мс
+#define FUSION_POLL_MAX 30000     // предел периода опроса, когда генерация затянулась, мс
 #define FUSION_TRIES 5
+#define FUSION_RETRY 2000    // пауза перед повтором запроса
+#define FUSION_TIMEOUT 2000  // ожидание ответа сервера
+#define FUSION_SLICE 20      // время работы декодера за один tick, мс
 #define FUS_LOG(x) Serial.println(x)
+#define FUSION_LUT_HEAP 24000  // свободный блок кучи, при котором декодер берёт таблицы Хаффмана (+6 КБ)
+#define FUSION_BAND_SIZE 12288  // буфер полосы из ряда MCU на время вывода картинки (ширина * высота MCU * 2 байта, 384x16 px), 0 - выводить по одному MCU
+#define FUSION_SESSIONS 2      // хостов с сохранённой сессией TLS
+#ifdef ESP8266
+#define FUSION_SOCKETS 1       // открытых соединений (пул ghttp): на ESP8266 не хватит памяти на два TLS
+#else
+#define FUSION_SOCKETS 2
+#endif
+#define FUSION_DRAIN 2048      // недочитанный ответ до этого размера дочитывается, чтобы не рвать соединение
+#define FUSION_QUEUE 2         // генераций в очереди: показываемая и заказанная про запас
+#define FUSION_RING 4          // файлов в кольце картинок про запас
 // #define GHTTP_HEADERS_LOG Serial
+// сжатые ответы (GHTTP_INFLATE, GHTTP_INFLATE_WINDOW) - в build_flags platformio.ini: от них зависит
+// устройство StreamReader, значит одинаковыми они должны быть во всех единицах трансляции
+#include <FS.h>
 #include <GSON.h>
+#include <GyverDB.h>
 #include <GyverHTTP.h>
+#include "Resampler.h"
 #include "StreamB64.h"
 #include "tjpgd/tjpgd.h"
 #ifdef ESP8266
@@ -26,17 +50,32 @@
 class Kandinsky {
     typedef std::function<void(int x, int y, int w, int h, uint8_t* buf)> RenderCallback;
     typedef std::function<void()> RenderEndCallback;
+    typedef std::function<void(const char* path)> CacheCallback;
     enum class State : uint8_t {
         GetModels,
         Generate,
         Status,
         GetStyles,
+        Local,  // вывод картинки про запас из флеша
     };
    public:
-    Kandinsky() {}
-    Kandinsky(const String& apikey, const String& secret_key) {
+    // куда пойдёт готовая картинка
+    enum class Dest : uint8_t {
+        Show,  // на экран (и в кэш)
+        Park,  // во флеш про запас (кольцо файлов), до showNext()
+        Drop,  // никуда: заказ отменён
+    };
+    Kandinsky() {
+        _http.setHook(&http);
+    }
+    Kandinsky(const String& apikey, const String& secret_key) : Kandinsky() {
         setKey(apikey, secret_key);
     }
+    ~Kandinsky() {
+        delete _b64;
+        delete[] _pool;
+        delete[] _band;
+    }
     void setKey(const String& apikey, const String& secret_key) {
         if (apikey.length() && secret_key.length()) {
             _api_key = "Key " + apikey;
@@ -49,6 +88,55 @@ class Kandinsky {
     void onRenderEnd(RenderEndCallback cb) {
         _end_cb = cb;
     }
+    // новая картинка показана и записана в кэш (path - файл кэша)
+    void onCache(CacheCallback cb) {
+        _cache_cb = cb;
+    }
+    // кэш последней картинки: JPEG пишется в файл во время вывода и заменяет старый только при успехе
+    void setCache(fs::FS* fs, const char* path) {
+        _fs = fs;
+        _cache_path = path;
+    }
+    // кольцо картинок про запас (на той же ФС, что и кэш): файлы prefix0.jpg .. prefix{FUSION_RING-1}.jpg.
+    // Генерация с Dest::Park раскладывает сюда все свои картинки, showNext() выводит их по очереди
+    void setNext(const char* prefix) {
+        _next_path = prefix;
+        _ring_pos = _ring_len = 0;
+        if (!_fs) return;
+        // после перезагрузки: очередь начинается с занятого слота после пустого
+        bool prev = _fs->exists(_slot(FUSION_RING - 1));
+        for (uint8_t i = 0; i < FUSION_RING; i++) {
+            bool cur = _fs->exists(_slot(i));
+            if (cur && !prev) _ring_pos = i;
+            if (cur) _ring_len++;
+            prev = cur;
+        }
+    }
+    // вывести картинку из кэша через тот же декодер. false - кэша нет или он битый
+    bool drawCache() {
+        if (!_fs || !_cache_path || !_fs->exists(_cache_path)) return false;
+        if (!_pool && !allocDecoder()) return false;
+        File file = _fs->open(_cache_path, "r");
+        if (!file) return false;
+        _raw = &file;
+        JRESULT jresult = _decode();
+        _raw = nullptr;
+        return jresult == JDR_OK;
+    }
+    // история длительностей генерации для расписания опроса
+    void setHistory(GyverDB* db) {
+        _db = db;
+    }
+    // выводить пиксели RGB565 в порядке big-endian (как их принимает дисплей по SPI)
+    void setSwapBytes(bool swap) {
+        _swap = swap;
+    }
+    // масштабировать картинку любого размера в кадр w x h (буферы выделяются здесь), 0 - выводить как есть.
+    // Уменьшение tjpgd тогда выбирается само, масштаб setScale не используется
+    bool setFrame(uint16_t w, uint16_t h, Resampler::Mode mode = Resampler::Mode::Fill) {
+        _fit = mode;
+        return _rs.alloc(w, h);
+    }
     // 1, 2, 4, 8
     void setScale(uint8_t scale) {
         switch (scale) {
@@ -59,196 +147,1026 @@ class Kandinsky {
             default: _scale = 0; break;
         }
     }
+    // выделить память декодеру JPEG один раз на всё время работы. lut - быстрые таблицы Хаффмана, если хватит кучи
+    bool allocDecoder(bool lut = true) {
+        delete[] _pool;
+        _pool = nullptr;
+#if JD_FASTDECODE == 2
+#ifdef ESP8266
+        if (ESP.getMaxFreeBlockSize() < FUSION_LUT_HEAP) lut = false;
+#endif
+        if (lut) {
+            _pool = new uint8_t[TJPGD_WORKSPACE_SIZE_LUT];
+            _pool_size = TJPGD_WORKSPACE_SIZE_LUT;
+        }
+#endif
+        if (!_pool) {
+            _pool = new uint8_t[TJPGD_WORKSPACE_SIZE];
+            _pool_size = TJPGD_WORKSPACE_SIZE;
+        }
+        if (!_pool) _pool_size = 0;
+        return _pool;
+    }
+    // размер памяти декодера JPEG
+    size_t decoderSize() {
+        return _pool_size;
+    }
     bool begin() {
+        if (!_pool) allocDecoder();
         if (!_api_key.length()) return false;
-        return request(State::GetModels, PROXY_HOST, PROXY_PORT, "/key/api/v1/pipelines");
+        return request(State::GetModels, PROXY_HOST, PROXY_PORT, F("/key/api/v1/pipelines"));
     }
     bool getStyles() {
         if (!_api_key.length()) return false;
-        return request(State::GetStyles, "cdn.fusionbrain.ai", FUSION_PORT, "/static/styles/web");
+        return request(State::GetStyles, "cdn.fusionbrain.ai", FUSION_PORT, F("/static/styles/web"));
     }
-    bool generate(Text query, uint16_t width = 512, uint16_t height = 512, Text style = "DEFAULT", Text negative = "") {
+    // заказать генерацию. dest - вывести по готовности или сохранить про запас, images - картинок за запуск
+    // (при выводе первая идёт на экран, остальные в кольцо)
+    bool generate(Text query, uint16_t width = 512, uint16_t height = 512, Text style = "DEFAULT", Text negative = "", Dest dest = Dest::Show, uint8_t images = 1) {
+        if (_jobs_len >= FUSION_QUEUE) {
+            status = "queue full";
+            return false;
+        }
         status = "wrong config";
         if (!_api_key.length()) return false;
         if (!style.length()) return false;
         if (!query.length()) return false;
         if (!_id.length()) return false;
-        gson::string json;
-        json.beginObj();
-        json.addString(F("type"), F("GENERATE"));
-        json.addString(F("style"), style);
-        json.addString(F("negativePromptDecoder"), negative);
-        json.addInt(F("width"), width);
-        json.addInt(F("height"), height);
-        json.addInt(F("numImages"), 1);
-        json.beginObj(F("generateParams"));
-        json.addString(F("query"), query);
-        json.endObj();
-        json.endObj(true);
-        // FUS_LOG("JSON being sent:");
-        // FUS_LOG(json);
-        ghttp::Client::FormData data;
-        data.add("pipeline_id", "", "", Value(_id));
-        data.add("params", "blob", "application/json", json);
-        uint8_t tries = FUSION_TRIES;
-        while (tries--) {
-            if (request(State::Generate, PROXY_HOST, PROXY_PORT, "/key/api/v1/pipeline/run", "POST", &data)) {
-                FUS_LOG("Gen request sent");
-                status = "wait result";
-                return true;
-            } else {
-                FUS_LOG("Gen request error");
-                delay(2000);
-            }
+        if (!_start(State::Generate, PROXY_HOST, PROXY_PORT, F("/key/api/v1/pipeline/run"), "POST")) {
+            status = "busy";
+            return false;
         }
-        status = "gen request error";
-        return false;
+        _eta_key = "eta:";
+        _eta_key += width;
+        _eta_key += 'x';
+        _eta_key += height;
+        _eta_key += ':';
+        style.addString(_eta_key);
+        // форма ссылается на _id и _params, JSON печатается прямо в сокет при отправке
+        _params.query = query.toString();
+        _params.style = style.toString();
+        _params.negative = negative.toString();
+        _params.width = width;
+        _params.height = height;
+        _params.images = images;
+        _data.clear();
+        _data.add("pipeline_id", "", "", _id);
+        _data.add("params", "blob", "application/json", _params, _params.length());
+        _gen_dest = dest;
+        _tries = FUSION_TRIES - 1;
+        status = "gen request";
+        return true;
     }
     bool getImage() {
         if (!_api_key.length()) return false;
-        if (!_uuid.length()) return false;
+        if (!_jobs_len) return false;
         FUS_LOG("Check status...");
+        polls.requests++;
+        polls.total++;
+        _done = false;
+        _shown = false;
         String url("/key/api/v1/pipeline/status/");
-        url += _uuid;
-        return request(State::Status, PROXY_HOST, PROXY_PORT, url);
+        url += _jobs[0].uuid;
+        return _start(State::Status, PROXY_HOST, PROXY_PORT, url);
     }
+    // генераций в очереди
+    uint8_t queued() {
+        return _jobs_len;
+    }
+    // картинок про запас во флеше
+    uint8_t parked() {
+        return _ring_len;
+    }
+    // показать следующую картинку: готовую из флеша (локальный декод в tick) или заказанную
+    // про запас сразу по готовности. false - показывать нечего, нужна новая генерация
+    bool showNext() {
+        if (_ring_len) {
+            _show_parked = true;
+            return true;
+        }
+        for (uint8_t i = 0; i < _jobs_len; i++) {
+            if (_jobs[i].dest == Dest::Park) {
+                _jobs[i].dest = Dest::Show;
+                return true;
+            }
+        }
+        return false;
+    }
+    // вывести JPEG из файла (та же ФС) через tick, как картинку про запас. Кэш не меняется
+    bool showFile(const String& path) {
+        if (!_fs || busy()) return false;
+        _show_path = path;
+        return true;
+    }
+    // забыть картинки про запас (сменился промт): файлы удаляются, заказанные не скачиваются. Вызывать вне запроса
+    void clearNext() {
+        if (busy()) return;
+        for (uint8_t i = 0; i < _jobs_len; i++) {
+            if (_jobs[i].dest == Dest::Park || _jobs[i].taken) _jobs[i].dest = Dest::Drop;
+        }
+        _show_parked = false;
+        for (; _ring_len; _ring_len--) {
+            _fs->remove(_slot(_ring_pos));
+            _ring_pos = (_ring_pos + 1) % FUSION_RING;
+        }
+    }
+    // вызывать в loop: запросы и вывод картинки идут по шагам, не дольше FUSION_SLICE за вызов (кроме рукопожатия TLS)
     void tick() {
-        if (_uuid.length() && millis() - _tmr >= FUSION_PERIOD) {
+        if (_step != Step::Idle) {
+            _tick();
+        } else if (_show_parked || _show_path.length()) {
+            _localBegin();
+        } else if (_jobs_len && !_held() && millis() - _tmr >= _poll_prd) {
             _tmr = millis();
             getImage();
         }
     }
+    // идёт запрос
+    bool busy() {
+        return _step != Step::Idle;
+    }
+    // закрыть соединение с сервером (сессия TLS остаётся для следующего подключения)
+    void stop() {
+        _http.stop();
+        _socks.stop();
+    }
     String modelID() { return _id; }
     String styles = "";
     String status = "";
+    // счётчики соединений: запрос по открытому соединению, восстановленная сессия TLS, полное рукопожатие
+    struct {
+        uint16_t reused = 0;
+        uint16_t resumed = 0;
+        uint16_t handshakes = 0;
+    } conn;
+    // опрос статуса: каждый запрос - это обмен по TLS и расход квоты API
+    struct {
+        uint16_t requests = 0;  // запросов status для текущей (последней) картинки в очереди
+        uint32_t total = 0;     // запросов status всего
+        uint16_t images = 0;    // готовых картинок
+        uint16_t eta = 0;       // ожидаемая длительность текущей генерации, с
+        uint16_t median = 0;    // медиана длительности генерации по истории, с (0 - истории нет)
+    } polls;
+    // время запросов по фазам (DNS, подключение с TLS, отправка, первый байт, тело) по хостам. Serial.print(http) - таблица.
+    // DNS замеряется отдельно только с GHTTP_DNS_API, иначе входит в подключение
+    ghttp::Stats http;
    private:
+    // шаг текущего запроса
+    enum class Step : uint8_t {
+        Idle,
+        Wait,     // пауза перед повтором
+        Connect,  // подключение и рукопожатие TLS
+        Send,     // отправка запроса
+        Headers,  // ожидание ответа и заголовки
+        Body,     // тело ответа
+        Files,    // следующая строка files ответа status
+        Decode,   // вывод картинки
+        Park,     // запись картинки про запас во флеш
+    };
+    // параметры запроса generate, печатаются в JSON
+    struct Params : public Printable {
+        // длина JSON - пробным проходом
+        size_t length() const {
+            gson::Counter len;
+            printTo(len);
+            return len.length();
+        }
+
+        size_t printTo(Print& p) const {
+            gson::string json(p);
+            json.beginObj();
+            json.addString(F("type"), F("GENERATE"));
+            json.addString(F("style"), style);
+            json.addString(F("negativePromptDecoder"), negative);
+            json.addInt(F("width"), width);
+            json.addInt(F("height"), height);
+            json.addInt(F("numImages"), images);
+            json.beginObj(F("generateParams"));
+            json.addString(F("query"), query);
+            json.endObj();
+            json.endObj(true);
+            return json.length();
+        }
+
+        String query, style, negative;
+        uint16_t width = 0, height = 0;
+        uint8_t images = 0;
+    };
+    // генерация в очереди
+    struct Job {
+        String uuid;
+        String eta_key;
+        uint32_t start;  // момент запуска, мс
+        Dest dest;
+        uint8_t taken = 0;  // картинок пачки уже забрано (на экран и в кольцо)
+        bool done = false;  // генерация готова, длительность учтена
+    };
+
     String _api_key;
     String _secret_key;
-    String _uuid;
+    Job _jobs[FUSION_QUEUE];  // по порядку заказа, опрашивается первая
+    uint8_t _jobs_len = 0;
+    Dest _gen_dest = Dest::Show;  // для отправляемого запроса generate
+    bool _done = false;           // первая генерация очереди закончилась (DONE или FAIL)
+    bool _shown = false;          // картинка этой генерации уже пошла на экран
     uint8_t _scale = 0;
     uint32_t _tmr = 0;
+    uint32_t _gen_tmr = 0;   // начало генерации
+    uint32_t _poll_prd = 0;  // ожидание до следующего опроса
+    GyverDB* _db = nullptr;
+    String _eta_key;  // ключ истории для отправляемого запроса generate
     String _id;
     RenderCallback _rnd_cb = nullptr;
     RenderEndCallback _end_cb = nullptr;
+    CacheCallback _cache_cb = nullptr;
+    FUSION_CLIENT _clients[FUSION_SOCKETS];
+    ghttp::Pool _socks{_clients};
+    ghttp::Client _http{_socks, PROXY_HOST, PROXY_PORT};
+    const char* _host = PROXY_HOST;
+    uint16_t _port = PROXY_PORT;
+#ifdef ESP8266
+    struct {
+        const char* host = nullptr;
+        uint16_t port = 0;
+        BearSSL::Session ssl;
+    } _sessions[FUSION_SESSIONS];
+    uint8_t _sess_i = 0;
+#endif
+    State _state;
+    Step _step = Step::Idle;
+    String _url;
+    const char* _method = "GET";
+    ghttp::Client::StreamForm _data;
+    Params _params;
+    ghttp::Client::Response _resp;
+    gtl::stack_uniq<uint8_t> _text;  // короткий JSON ответа
+    uint32_t _step_tmr = 0;
+    uint8_t _tries = 0;
+    bool _reused = false;
+    bool _plain = false;  // не просить сжатие
+    bool _ok = false;
+    gson::StreamParser _json;  // ответ status потоком
+    uint8_t _skip = 0;         // строк files, которые пропускаются
+    bool _rest = false;        // строка files после выведенной или записанной картинки
+    StreamB64* _b64 = nullptr;
+    JRESULT _jres = JDR_OK;
     StreamB64* _stream = nullptr;
+    Stream* _raw = nullptr;  // JPEG без base64 (файл кэша)
+    fs::FS* _fs = nullptr;
+    const char* _cache_path = nullptr;
+    const char* _next_path = nullptr;
+    String _cache_dst;  // куда переименуется _cache
+    File _cache;
+    File _file;  // картинка про запас при выводе
+    uint8_t _ring_pos = 0;  // слот следующей картинки про запас
+    uint8_t _ring_len = 0;  // занятых слотов
+    uint8_t _local_slot = 0;  // выводимый слот кольца, FUSION_RING - файл showFile()
+    bool _show_parked = false;
+    String _show_path;
+    bool _park_ok = false;
+    uint16_t _park_tail = 0;  // два последних байта записанного JPEG
+    JDEC _jdec;
+    uint8_t* _pool = nullptr;
+    size_t _pool_size = 0;
+    uint8_t* _band = nullptr;
+    uint16_t _band_w = 0;  // ширина полосы, 0 - полоса не используется
+    Resampler _rs;
+    Resampler::Mode _fit = Resampler::Mode::Fill;
+    bool _swap = false;
     // static
     static Kandinsky* self;
-    static size_t jd_input_cb(JDEC* jdec, uint8_t* buf, size_t len) {
-        if (self) {
-            self->_stream->readBytes(buf, len);
+    static size_t jd_input_cb(JDEC* /*jdec*/, uint8_t* buf, size_t len) {
+        if (!self) return 0;
+        // пропуск через буфер, если пропущенное нужно записать в кэш или поток не умеет пропускать
+        if (!buf && (self->_cache || !self->_stream)) {
+            uint8_t tmp[64];
+            size_t read = 0;
+            while (len) {
+                size_t r = self->_read(tmp, min(len, sizeof(tmp)));
+                if (!r) break;
+                read += r;
+                len -= r;
+            }
+            return read;
         }
-        return len;
+        return self->_read(buf, len);
     }
-    static int jd_output_cb(JDEC* jdec, void* bitmap, JRECT* rect) {
-        if (self && self->_rnd_cb) {
-            self->_rnd_cb(rect->left, rect->top, rect->right - rect->left + 1, rect->bottom - rect->top + 1, (uint8_t*)bitmap);
+    size_t _read(uint8_t* buf, size_t len) {
+        size_t read = _stream ? _stream->readBytes(buf, len) : (_raw ? _raw->readBytes(buf, len) : 0);
+        if (_cache && buf && read && _cache.write(buf, read) != read) {
+            FUS_LOG("cache write error");
+            _cacheEnd(false);
+        }
+        return read;
+    }
+    static int jd_output_cb(JDEC* /*jdec*/, void* bitmap, JRECT* rect) {
+        if (!self || !self->_rnd_cb) return 1;
+        uint16_t w = rect->right - rect->left + 1;
+        uint16_t h = rect->bottom - rect->top + 1;
+        uint16_t bw = self->_band_w;
+        if (!bw) {
+            self->_rnd_cb(rect->left, rect->top, w, h, (uint8_t*)bitmap);
+            return 1;
+        }
+        // собираем ряд MCU в полосу и выводим её целиком после последнего MCU в ряду
+        uint16_t* band = (uint16_t*)self->_band + rect->left;
+        uint16_t* mcu = (uint16_t*)bitmap;
+        for (uint16_t i = 0; i < h; i++) {
+            memcpy(band, mcu, w * 2);
+            band += bw;
+            mcu += w;
+        }
+        if (rect->right + 1 >= bw) {
+            if (self->_rs.active()) self->_rs.write(rect->top, h, self->_band, bw);
+            else self->_rnd_cb(0, rect->top, bw, h, self->_band);
         }
         return 1;
     }
+
+   public:
+    // размер выходной картинки, как её режет tjpgd
+    static uint16_t outSize(uint16_t size, uint16_t mcu, uint8_t scale) {
+        uint16_t last = (size - 1) / mcu * mcu;
+        return (last >> scale) + ((size - last) >> scale);
+    }
+    // ширина выходной картинки или 0, если полоса не помещается в буфер
+    static uint16_t bandWidth(JDEC& jd, uint8_t scale, uint8_t* band) {
+        if (!band) return 0;
+        uint16_t w = outSize(jd.width, jd.msx * 8, scale);
+        return ((size_t)w * ((jd.msy * 8) >> scale) * 2 <= FUSION_BAND_SIZE) ? w : 0;
+    }
+    // наибольшее уменьшение tjpgd (0..3), после которого картинка w x h ещё не меньше кадра fw x fh
+    static uint8_t frameScale(uint16_t w, uint16_t h, uint16_t fw, uint16_t fh, Resampler::Mode mode) {
+        uint8_t s = 3;
+        for (; s; s--) {
+            bool wok = (w >> s) >= fw;
+            bool hok = (h >> s) >= fh;
+            if (mode == Resampler::Mode::Fit ? (wok || hok) : (wok && hok)) break;
+        }
+        return s;
+    }
+
+   private:
     // system
-    bool request(State state, Text host, int port, Text url, Text method = "GET", ghttp::Client::FormData* data = nullptr) {
-        FUSION_CLIENT client;
+    // выполнить запрос до конца (вызовы из setup)
+    bool request(State state, const char* host, uint16_t port, const String& url) {
+        if (!_start(state, host, port, url)) return false;
+        while (_step != Step::Idle) {
+            _tick();
+            delay(1);
+        }
+        return _ok;
+    }
+
+    // начать запрос, дальше его ведёт tick().
+    // Соединения берутся из пула по хосту и остаются открытыми, пока сервер не закроет их или не истечёт простой (keep-alive).
+    // При смене хоста соединение возвращается в пул. На ESP8266 сокет в пуле один - соединение со старым хостом закроется
+    bool _start(State state, const char* host, uint16_t port, const String& url, const char* method = "GET") {
+        if (_step != Step::Idle) return false;
+        if (_port != port || strcmp(_host, host)) {
+            _host = host;
+            _port = port;
+            _http.setHost(_host, _port);
+        }
+        _state = state;
+        _url = url;
+        _method = method;
+        _resp = ghttp::Client::Response();
+        _tries = 0;
+        _step = Step::Connect;
+        return true;
+    }
+
+    void _tick() {
+        switch (_step) {
+            case Step::Idle:
+                break;
+
+            case Step::Wait:
+                if (millis() - _step_tmr >= FUSION_RETRY) _step = Step::Connect;
+                break;
+
+            case Step::Connect: {
+                // connect() у BearSSL блокирующий - рукопожатие занимает один шаг целиком
+                FUSION_CLIENT* client = static_cast<FUSION_CLIENT*>(_http.socket());
+                if (!client) return _fail();
+                _reused = _http.connected();
+                if (!_reused) {
 #ifdef ESP8266
-        client.setBufferSizes(512, 512);
+                    client->setBufferSizes(512, 512);
 #endif
-        client.setInsecure();
-        ghttp::Client http(client, host.str(), port);
+                    client->setInsecure();
+                    if (!_connect(*client)) return _fail();
+                }
+                _step = Step::Send;
+            } break;
+
+            case Step::Send: {
+                // короткие JSON (стили, модели, запуск) сжимаются хорошо. В status картинка base64 на сотню КБ:
+                // окно распаковки меньше окна сервера, и base64 почти не сжимается
+                _http.setAcceptEncoding(!_plain && _state != State::Status);
+                bool ok = (_state == State::Generate) ? _http.request(_url, _method, _headers(), _data)
+                                                      : _http.request(_url, _method, _headers());
+                if (!ok || !_http.isWaiting()) return _fail();
+                _step_tmr = millis();
+                _step = Step::Headers;
+            } break;
+
+            case Step::Headers:
+                if (!_http.available()) {
+                    if (!_http.isWaiting() || millis() - _step_tmr >= FUSION_TIMEOUT) _fail();
+                    break;
+                }
+                _resp = _http.getResponse();
+                if (!_resp.code()) return _fail();
+                if (_reused) conn.reused++;
+                FUS_LOG("Response code: " + String(_resp.code())+"  " );
+                if (_resp.code() < 200 || _resp.code() >= 300) {
+                    FUS_LOG("Error" + String(_resp.code()));
+                    FUS_LOG("Response error");
+                    return _finish(false);
+                }
+                if (_state == State::Status) {
+                    // ответ разбирается по мере прихода, next() не ждёт данные
+                    _json.begin(_resp.body());
+                    _json.setWait(false);
+                }
+                _step_tmr = millis();
+                _step = Step::Body;
+                break;
+
+            case Step::Body:
+                if (_state == State::Status) {
+                    int8_t res = _parseStatusHead();
+                    if (res > 1) return _waitBody();
+                    if (res <= 0) return _finish(res == 0);
+                    // картинки, забранные до того, как кольцо заполнилось, пропускаются
+                    _skip = _jobs_len ? _jobs[0].taken : 0;
+                    _rest = false;
+                    _step = Step::Files;
+                } else {
+                    // короткий JSON копится по мере прихода, loop не ждёт остальное
+                    uint8_t buf[128];
+                    size_t n;
+                    while ((n = _resp.body().readAvailable(buf, sizeof(buf)))) {
+                        _text.write(buf, n);
+                        _step_tmr = millis();
+                    }
+                    if (_resp.body().available()) return _waitBody();
+                    gson::Parser json;
+                    if (_resp.body().error() || !json.parse(_text.buf(), _text.length(), _fields(_state))) {
+                        FUS_LOG("Parse error");
+                        return _finish(false);
+                    }
+                    _finish(parse(_state, json));
+                }
+                break;
+
+            case Step::Files: {
+                int8_t res;
+                while ((res = _nextFile()) == 1 && _skip) _skip--;
+                if (res > 1) return _waitBody();
+                if (!res) return _finish(true);
+                if (_rest) {
+                    // кольцо полно - остаток пачки заберётся повторным опросом после showNext()
+                    if (_ring_len >= FUSION_RING) {
+                        _done = false;
+                        return _finish(true);
+                    }
+                    _b64 = new StreamB64(_json.string());
+                    if (!_parkBegin()) return _finish(true);
+                    _step = Step::Park;
+                } else {
+                    switch (_jobDest()) {
+                        case Dest::Show:
+                            _shown = true;
+                            if (_jobs_len) _jobs[0].taken++;
+                            if (!_decodeBegin(&_json.string())) return _finish(false);
+                            _step = Step::Decode;
+                            break;
+                        case Dest::Park:
+                            if (_ring_len >= FUSION_RING) {
+                                // готовые картинки не выбрасываются: генерация ждёт в очереди, пока showNext() не освободит слот
+                                _done = false;
+                                status = "ring full";
+                                return _finish(true);
+                            }
+                            _b64 = new StreamB64(_json.string());
+                            if (!_parkBegin()) return _finish(false);
+                            _step = Step::Park;
+                            break;
+                        case Dest::Drop:
+                            return _finish(true);
+                    }
+                }
+            } break;
+
+            case Step::Decode:
+                if (_decodeSlice(FUSION_SLICE)) _parkRest(_jres == JDR_OK);
+                break;
+
+            case Step::Park:
+                if (_parkSlice(FUSION_SLICE)) _parkRest(_park_ok);
+                break;
+        }
+    }
+
+    // ошибка связи. Если соединение было открыто с прошлого запроса, сервер мог закрыть его - повторяем по новому
+    void _fail() {
+        _http.stop();
+        if (_reused) {
+            FUS_LOG("Reconnect");
+            _reused = false;
+            _step = Step::Connect;
+            return;
+        }
+        FUS_LOG("Request error");
+        _finish(false);
+    }
+
+    void _finish(bool ok) {
+        delete _b64;
+        _b64 = nullptr;
+        // соединение можно оставить, только если ответ дочитан до конца
+        if (_state != State::Local && _http.connected()) {
+            if (!_drain(_resp.body())) _http.stop();
+            else _http.flush();
+        }
+#ifdef GHTTP_INFLATE
+        // сжатый ответ не распаковался (сервер сослался дальше окна) - повторы и дальше без сжатия
+        if (_resp.body().isInflated() && _resp.body().error()) _plain = true;
+#endif
+        _resp = ghttp::Client::Response();
+        _text.reset();
+        if (!ok && _tries) {
+            _tries--;
+            FUS_LOG("Retry");
+            _step_tmr = millis();
+            _step = Step::Wait;
+            return;
+        }
+        _step = Step::Idle;
+        _ok = ok;
+        switch (_state) {
+            case State::Generate:
+                FUS_LOG(ok ? "Gen request sent" : "Gen request error");
+                status = ok ? "wait result" : "gen request error";
+                _data.clear();
+                _params = Params();
+                break;
+            case State::Status:
+                if (_done) _jobsPop();
+                // опрос закончен - следующий запрос будет нескоро
+                if (!_jobs_len) _http.stop();
+                break;
+            case State::Local:
+                // выведенная картинка про запас становится кэшем последней, битая удаляется
+                if (_local_slot < FUSION_RING) {
+                    String slot = _slot(_local_slot);
+                    if (!ok || !_cache_path || !_fs->rename(slot.c_str(), _cache_path)) _fs->remove(slot.c_str());
+                    else if (_cache_cb) _cache_cb(_cache_path);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    ghttp::Client::Headers _headers() {
         ghttp::Client::Headers headers;
         headers.add("X-Key", _api_key);
         headers.add("X-Secret", _secret_key);
-        bool ok = data ? http.request(url, method, headers, *data)
-                       : http.request(url, method, headers);
-        if (!ok) {
-            FUS_LOG("Request error");
-            return false;
+        return headers;
+    }
+
+#ifdef ESP8266
+    // параметры сессии TLS: BearSSL::Session хранит только их, а getSession() у неё закрыт
+    static const br_ssl_session_parameters& _sslParams(const BearSSL::Session& ssl) {
+        static_assert(sizeof(BearSSL::Session) == sizeof(br_ssl_session_parameters), "BearSSL::Session layout");
+        return *reinterpret_cast<const br_ssl_session_parameters*>(&ssl);
+    }
+#endif
+
+    // подключиться с восстановлением сессии TLS этого хоста
+    bool _connect(FUSION_CLIENT& client) {
+#ifdef ESP8266
+        uint8_t i = 0;
+        while (i < FUSION_SESSIONS && !(_sessions[i].host && _sessions[i].port == _port && !strcmp(_sessions[i].host, _host))) i++;
+        if (i == FUSION_SESSIONS) {
+            i = _sess_i;
+            _sess_i = (_sess_i + 1) % FUSION_SESSIONS;
+            _sessions[i].host = _host;
+            _sessions[i].port = _port;
+            _sessions[i].ssl = BearSSL::Session();
         }
-        ghttp::Client::Response resp = http.getResponse();
-        FUS_LOG("Response code: " + String(resp.code())+"  " );
-        if (resp.code() >= 200 && resp.code() < 300) {
-            if (state == State::Status) {
-                bool ok = parseStatus(resp.body());
-                http.flush();
-                return ok;
-            } else {
-                gtl::stack_uniq<uint8_t> str;
-                resp.body().writeTo(str);
-                gson::Parser json;
-                if (!json.parse(str.buf(), str.length())) {
-                    FUS_LOG("Parse error");
-                    return false;
-                }
-                return parse(state, json);
-            }
-        } else {
-            http.flush();
-            FUS_LOG("Error" + String(resp.code()));
-            FUS_LOG("Response error");
+        BearSSL::Session& ssl = _sessions[i].ssl;
+        // сессия восстановлена, если сервер принял её id: после полного рукопожатия id новый
+        const br_ssl_session_parameters& par = _sslParams(ssl);
+        uint8_t prev_id[sizeof(par.session_id)];
+        uint8_t prev_len = par.session_id_len;
+        memcpy(prev_id, par.session_id, prev_len);
+        client.setSession(&ssl);
+        if (!_http.connect()) return false;
+        if (prev_len && par.session_id_len == prev_len && !memcmp(prev_id, par.session_id, prev_len)) conn.resumed++;
+        else conn.handshakes++;
+#else
+        (void)client;
+        if (!_http.connect()) return false;
+        conn.handshakes++;
+#endif
+        FUS_LOG("TLS: " + String(conn.handshakes) + " handshakes, " + String(conn.resumed) + " resumed, " + String(conn.reused) + " reused");
+        return true;
+    }
+
+    // дочитать небольшой остаток ответа. false - остаток слишком большой или ошибка чтения
+    static bool _drain(StreamReader& body) {
+        uint8_t tmp[64];
+        size_t left = FUSION_DRAIN;
+        while (body.available()) {
+            if (!body.isChunked() && (size_t)body.available() > left) return false;
+            size_t r = body.readBytes((char*)tmp, min(left, sizeof(tmp)));
+            if (!r) return !body.available();
+            left -= r;
         }
-        return false;
+        return true;
     }
+
+   public:
+    // разобрать ответ status из потока и вывести картинку (используется и хостовым бенчмарком)
     bool parseStatus(Stream& stream) {
-        bool found = false;
-        bool insideResult = false;
-        while (stream.available()) {
-                //FUS_LOG(stream.readString());
-                //return false;
-            stream.readStringUntil('"');
-            String key = stream.readStringUntil('"');
-            if (key == "result") {
-                insideResult = true;
-                continue;
+        _json.begin(stream);
+        _json.setWait(true);
+        int8_t res = _parseStatusHead();
+        if (res <= 0) return res == 0;
+        if (_nextFile() != 1) return true;
+        bool ok = _decodeBegin(&_json.string());
+        if (ok) {
+            while (!_decodeSlice(FUSION_SLICE)) {}
+            ok = _jres == JDR_OK;
+        }
+        delete _b64;
+        _b64 = nullptr;
+        return ok;
+    }
+
+   private:
+    // ответ status до массива files. 1 - дальше идут картинки (_nextFile), 0 - картинок нет, -1 - ошибка генерации,
+    // 2 - данные ещё не пришли, разбор продолжится с того же места следующим вызовом
+    int8_t _parseStatusHead() {
+        while (true) {
+            switch (_json.next()) {
+                case gson::StreamParser::Event::More:
+                    return 2;
+
+                case gson::StreamParser::Event::None:
+                    if (_json.hasError()) FUS_LOG(_json.readError());
+                    return 0;
+
+                case gson::StreamParser::Event::Array:
+                    if (_json.key() == "files") return 1;
+                    break;
+
+                case gson::StreamParser::Event::Value:
+                    if (_json.key() != "status") break;
+                    switch (_json.value().hash()) {
+                        case SH("INITIAL"):
+                        case SH("PROCESSING"):
+                            _pollNext();
+                            return 0;
+                        case SH("DONE"):
+                            if (_jobs_len && !_jobs[0].done) {
+                                _jobs[0].done = true;
+                                _pollDone();
+                            }
+                            _done = true;
+                            break;
+                        case SH("FAIL"):
+                            _done = true;
+                            status = "gen fail";
+                            return -1;
+                    }
+                    break;
+
+                default:
+                    break;
             }
-            if (insideResult && key == "files") {
-                found = true;
-                
+        }
+    }
+
+    // следующая строка массива files: 1 - строка (_json.string()), 0 - строк больше нет, 2 - данные ещё не пришли
+    int8_t _nextFile() {
+        switch (_json.next()) {
+            case gson::StreamParser::Event::More:
+                return 2;
+            case gson::StreamParser::Event::Value:
+                return _json.is(gson::Type::String);
+            default:
+                return 0;
+        }
+    }
+    // тело пришло не целиком: ждать следующий tick, пока идут данные. Тело дочитано или соединение встало - ошибка
+    void _waitBody() {
+        if (!_resp.body().available()) return _finish(false);
+        if (_http.socket()->available()) _step_tmr = millis();
+        else if (!_http.socket()->connected() || millis() - _step_tmr >= FUSION_TIMEOUT) _finish(false);
+    }
+
+    // начать вывод картинки из base64 строки (nullptr - JPEG из _raw), дальше по кускам через _decodeSlice
+    bool _decodeBegin(Stream* stream) {
+        if (!_pool && !allocDecoder()) {
+            FUS_LOG("allocate error");
+            return false;
+        }
+        if (stream) {
+            delete _b64;
+            _b64 = new StreamB64(*stream);
+            _stream = _b64;
+            if (_cache_path) _cacheBegin(_cache_path);
+        }
+        _bandBegin();
+        _jdec.swap = _swap;
+        self = this;
+        JRESULT jresult = jd_prepare(&_jdec, jd_input_cb, _pool, _pool_size, 0);
+        if (jresult == JDR_OK) {
+            jresult = _setup();
+        } else {
+            FUS_LOG("jdec error");
+        }
+        self = nullptr;
+        if (jresult != JDR_OK) _decodeEnd(jresult);
+        // заголовок JPEG читается целиком, дальше MCU декодируются по мере прихода строки
+        else if (_stream) _stream->setWait(false);
+        return jresult == JDR_OK;
+    }
+
+    // декодировать MCU в течение ms миллисекунд или пока пришедшее не кончится. true - картинка закончилась (результат в _jres)
+    bool _decodeSlice(uint32_t ms) {
+        uint32_t tmr = millis();
+        JRESULT jresult = JDR_OK;
+        bool wait = false;
+        uint16_t mcus = 0;
+        self = this;
+        do {
+            if (_stream && !_stream->ready()) {
+                wait = true;
                 break;
             }
-            stream.readStringUntil('"');
-            String val = stream.readStringUntil('"');
-            if (!key.length() || !val.length()) break;
-            if (key == "status") {
-                switch (Text(val).hash()) {
-                    case SH("INITIAL"):
-                    case SH("PROCESSING"):
-                        return true;
-                    case SH("DONE"):
-                        _uuid = "";
-                        break;
-                    case SH("FAIL"):
-                        _uuid = "";
-                        status = "gen fail";
-                        return false;
-                }
-            }
+            jresult = jd_decomp_mcus(&_jdec, jd_output_cb, 1);
+            mcus++;
+        } while (jresult == JDR_OK && _jdec.mcuy < _jdec.height && millis() - tmr < ms);
+        self = nullptr;
+        if (mcus) _step_tmr = millis();
+        else if (wait && millis() - _step_tmr >= FUSION_TIMEOUT) jresult = JDR_INP;
+        if (jresult != JDR_OK || _jdec.mcuy >= _jdec.height) {
+            _decodeEnd(jresult);
+            return true;
         }
-        if (found) {
-            stream.readStringUntil('"');
-            uint8_t* workspace = new uint8_t[TJPGD_WORKSPACE_SIZE];
-            if (!workspace) {
-                FUS_LOG("allocate error");
-                return false;
+        return false;
+    }
+
+    void _decodeEnd(JRESULT jresult) {
+        _rs.end();
+        _bandEnd();
+        if (jresult == JDR_OK) {
+            if (_end_cb) _end_cb();
+            if (_stream) {
+                // хвост JPEG после последнего MCU (маркер EOI): чтобы файл кэша был целым и поток встал на конец строки
+                _stream->setWait(true);
+                uint8_t tmp[64];
+                while (_read(tmp, sizeof(tmp))) {}
             }
-            JDEC jdec;
-            jdec.swap = 0;
-            JRESULT jresult = JDR_OK;
-            StreamB64 sb64(stream);
-            _stream = &sb64;
-            self = this;
-            jresult = jd_prepare(&jdec, jd_input_cb, workspace, TJPGD_WORKSPACE_SIZE, 0);
-            if (jresult == JDR_OK) {
-                jresult = jd_decomp(&jdec, jd_output_cb, _scale);
-                if (jresult == JDR_OK && _end_cb) _end_cb();
-            } else {
-                FUS_LOG("jdec error");
+        }
+        _cacheEnd(jresult == JDR_OK);
+        _stream = nullptr;
+        _raw = nullptr;
+        _file.close();
+        _jres = jresult;
+        status = jresult == JDR_OK ? "gen done" : ("jpg error");
+        status += String(jresult);
+    }
+
+    JRESULT _decode() {
+        _bandBegin();
+        _jdec.swap = _swap;
+        self = this;
+        JRESULT jresult = jd_prepare(&_jdec, jd_input_cb, _pool, _pool_size, 0);
+        if (jresult == JDR_OK) jresult = _setup();
+        if (jresult == JDR_OK) {
+            jresult = jd_decomp_mcus(&_jdec, jd_output_cb, (unsigned int)-1);
+            _rs.end();
+            if (jresult == JDR_OK && _end_cb) _end_cb();
+        } else {
+            FUS_LOG("jdec error");
+        }
+        self = nullptr;
+        _bandEnd();
+        return jresult;
+    }
+
+    // полоса из ряда MCU нужна только на время вывода картинки
+    void _bandBegin() {
+#if FUSION_BAND_SIZE
+        if (!_band) _band = new uint8_t[FUSION_BAND_SIZE];
+#endif
+    }
+    void _bandEnd() {
+        delete[] _band;
+        _band = nullptr;
+        _band_w = 0;
+    }
+    // после jd_prepare: уменьшение tjpgd, полоса и ресемплер под размер картинки
+    JRESULT _setup() {
+        uint8_t scale = _scale;
+        if (_rs.width()) scale = frameScale(_jdec.width, _jdec.height, _rs.width(), _rs.height(), _fit);
+        _band_w = bandWidth(_jdec, scale, _band);
+        uint16_t h = outSize(_jdec.height, _jdec.msy * 8, scale);
+        // картинка уже размером с кадр - полосы идут на вывод как есть
+        if (_rs.width() && (_band_w != _rs.width() || h != _rs.height())) {
+            if (!_band_w || !_rs.begin(_band_w, h, _fit, _swap, &_rnd_cb)) FUS_LOG("resampler off");
+        }
+        return jd_decomp_init(&_jdec, scale);
+    }
+    void _cacheBegin(const String& path) {
+        if (!_fs) return;
+        _cache_dst = path;
+        _cache = _fs->open(path + ".tmp", "w");
+        if (!_cache) FUS_LOG("cache open error");
+    }
+    // закрыть временный файл и заменить им старый, если картинка записана целиком
+    void _cacheEnd(bool ok) {
+        if (!_cache) return;
+        _cache.close();
+        String tmp = _cache_dst + ".tmp";
+        if (!ok || !_fs->rename(tmp.c_str(), _cache_dst.c_str())) _fs->remove(tmp.c_str());
+        else if (_cache_cb && _cache_path && _cache_dst == _cache_path) _cache_cb(_cache_path);
+    }
+
+    String _slot(uint8_t i) {
+        return String(_next_path) + String(i) + ".jpg";
+    }
+    // картинка про запас: строка base64 из _b64 декодируется прямо в свободный слот кольца, без JPEG декодера
+    bool _parkBegin() {
+        if (!_fs || !_next_path) return false;
+        _cacheBegin(_slot((_ring_pos + _ring_len) % FUSION_RING));
+        if (!_cache) return false;
+        _b64->setWait(false);
+        _park_tail = 0;
+        status = "gen park";
+        return true;
+    }
+    // записать кусок за ms миллисекунд или пока пришедшее не кончится. true - закончено (результат в _park_ok)
+    bool _parkSlice(uint32_t ms) {
+        uint8_t buf[256];
+        uint32_t tmr = millis();
+        do {
+            if (!_b64->ready()) return millis() - _step_tmr >= FUSION_TIMEOUT ? _parkEnd(false) : false;
+            size_t n = _b64->readBytes(buf, sizeof(buf));
+            _step_tmr = millis();
+            if (n && _cache.write(buf, n) != n) {
+                FUS_LOG("park write error");
+                return _parkEnd(false);
             }
-            self = nullptr;
-            delete[] workspace;
-            status = jresult == JDR_OK ? "gen done" : ("jpg error");
-            status += String(jresult);
-            return jresult == JDR_OK;
+            if (n >= 2) _park_tail = (buf[n - 2] << 8) | buf[n - 1];
+            else if (n) _park_tail = (_park_tail << 8) | buf[0];
+            // строка кончилась: JPEG целый, только если кончается маркером EOI
+            if (_b64->ended()) return _parkEnd(_park_tail == 0xFFD9);
+        } while (millis() - tmr < ms);
+        return false;
+    }
+    bool _parkEnd(bool ok) {
+        _cacheEnd(ok);
+        _park_ok = ok;
+        if (ok) {
+            _ring_len++;
+            // пока скачивали, картинку уже попросили показать
+            if (_jobs_len && _jobDest() == Dest::Show && !_shown) _show_parked = _shown = true;
+            if (_state == State::Status && _jobs_len) _jobs[0].taken++;
         }
+        status = ok ? "next ready" : "park error";
         return true;
     }
+    // после картинки ответа: остальные картинки пачки - в кольцо, пока есть место
+    void _parkRest(bool ok) {
+        // декодер строки отдаёт взятый у потока буфер - удаляется до перехода к следующей строке
+        delete _b64;
+        _b64 = nullptr;
+        if (ok && _state == State::Status) {
+            _skip = 0;
+            _rest = true;
+            _step = Step::Files;
+            return;
+        }
+        _finish(ok);
+    }
+    // куда идёт следующая картинка первой генерации: после показанной - в кольцо
+    Dest _jobDest() {
+        if (!_jobs_len) return Dest::Show;
+        if (_jobs[0].taken && _jobs[0].dest == Dest::Show) return Dest::Park;
+        return _jobs[0].dest;
+    }
+    // первую генерацию некуда забирать: кольцо полно, опрос ждёт showNext()
+    bool _held() {
+        return _ring_len >= FUSION_RING && _jobDest() == Dest::Park;
+    }
+    // вывести файл showFile() или следующую картинку про запас через общий шаг Decode
+    void _localBegin() {
+        String path;
+        if (_show_path.length()) {
+            path = _show_path;
+            _show_path = "";
+            _local_slot = FUSION_RING;
+        } else {
+            _show_parked = false;
+            if (!_ring_len) return;
+            _local_slot = _ring_pos;
+            _ring_pos = (_ring_pos + 1) % FUSION_RING;
+            _ring_len--;
+            path = _slot(_local_slot);
+        }
+        _file = _fs->open(path, "r");
+        if (!_file) return;
+        _raw = &_file;
+        _state = State::Local;
+        _tries = 0;
+        _resp = ghttp::Client::Response();
+        if (!_decodeBegin(nullptr)) return _finish(false);
+        _step = Step::Decode;
+    }
+    // первая генерация очереди закончилась, опрашивается следующая
+    void _jobsPop() {
+        for (uint8_t i = 1; i < _jobs_len; i++) _jobs[i - 1] = _jobs[i];
+        _jobs[--_jobs_len] = Job();
+        if (_jobs_len) _pollBegin();
+    }
+
+    // история длительностей генерации (кольцо, с)
+    struct History {
+        uint16_t dur[FUSION_ETA_HISTORY];
+        uint8_t len;
+        uint8_t pos;
+    };
+    History _history(const String& key) {
+        History h;
+        memset(&h, 0, sizeof(h));
+        if (_db && !_db->get(key).writeTo(h)) h.len = 0;
+        if (h.len > FUSION_ETA_HISTORY) h.len = 0;
+        return h;
+    }
+    static uint16_t _median(const History& h) {
+        if (!h.len) return 0;
+        uint16_t d[FUSION_ETA_HISTORY];
+        memcpy(d, h.dur, sizeof(d));
+        // вставками, длительностей несколько штук
+        for (uint8_t i = 1; i < h.len; i++) {
+            for (uint8_t j = i; j && d[j - 1] > d[j]; j--) {
+                uint16_t t = d[j];
+                d[j] = d[j - 1];
+                d[j - 1] = t;
+            }
+        }
+        return d[h.len / 2];
+    }
+
+    // первая генерация очереди: первый опрос незадолго до её ожидаемого окончания (отсчёт от запуска)
+    void _pollBegin() {
+        _gen_tmr = _tmr = _jobs[0].start;
+        polls.requests = 0;
+        polls.median = _median(_history(_jobs[0].eta_key));
+        polls.eta = polls.median ? polls.median : FUSION_ETA;
+        uint32_t eta = polls.eta * 1000ul;
+        _poll_prd = eta > FUSION_ETA_EARLY + FUSION_POLL_MIN ? eta - FUSION_ETA_EARLY : FUSION_POLL_MIN;
+    }
+    // ещё не готово: часто около ожидаемого окончания, дальше с нарастающей паузой
+    void _pollNext() {
+        uint32_t elapsed = millis() - _gen_tmr;
+        if (elapsed < polls.eta * 1000ul + FUSION_ETA_WINDOW) _poll_prd = FUSION_POLL_MIN;
+        else _poll_prd = min(max(_poll_prd, (uint32_t)FUSION_POLL_MIN) * 2, (uint32_t)FUSION_POLL_MAX);
+    }
+    // готово: длительность в историю
+    void _pollDone() {
+        polls.images++;
+        uint32_t dur = (millis() - _gen_tmr + 500) / 1000;
+        FUS_LOG("Gen time: " + String(dur) + " s, requests: " + String(polls.requests));
+        const String& key = _jobs[0].eta_key;
+        if (!_db || !key.length()) return;
+        History h = _history(key);
+        h.dur[h.pos] = min(dur, (uint32_t)UINT16_MAX);
+        h.pos = (h.pos + 1) % FUSION_ETA_HISTORY;
+        if (h.len < FUSION_ETA_HISTORY) h.len++;
+        _db->set(key, h);
+        polls.median = _median(h);
+    }
+
+    // поля ответа, которые читает parse(). Остальное парсер пропускает без записи
+    static const char* _fields(State state) {
+        switch (state) {
+            case State::GetStyles: return "[*].name";
+            case State::GetModels: return "[0].id";
+            case State::Generate: return "uuid";
+            default: return "";
+        }
+    }
+
     bool parse(State state, gson::Parser& json) {
         switch (state) {
             case State::GetStyles:
@@ -262,11 +1180,17 @@ class Kandinsky {
                 json[0]["id"].toString(_id);
                 if (_id.length()) return true;
                 break;
-            case State::Generate:
-                _tmr = millis();
-                json["uuid"].toString(_uuid);
-                if (_uuid.length()) return true;
-                break;
+            case State::Generate: {
+                Job& job = _jobs[_jobs_len];
+                job = Job();
+                json["uuid"].toString(job.uuid);
+                if (!job.uuid.length()) break;
+                job.eta_key = _eta_key;
+                job.start = millis();
+                job.dest = _gen_dest;
+                if (!_jobs_len++) _pollBegin();
+                return true;
+            }
             default:
                 break;
         }
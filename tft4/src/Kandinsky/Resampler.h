@@ -0,0 +1,223 @@
+#pragma once
+#include <Arduino.h>
+
+#include <functional>
+
+#ifndef RESAMPLER_BAND
+#define RESAMPLER_BAND 8  // строк кадра в полосе вывода
+#endif
+
+// Потоковое масштабирование RGB565 с произвольным коэффициентом усреднением по площади (box filter).
+// Картинка приходит полосами строк полной ширины сверху вниз, готовые строки кадра
+// копятся в полосу из RESAMPLER_BAND строк и отдаются в Callback полосой (одно окно дисплея). Веса целые: исходный пиксель - _hs x _vs долей,
+// пиксель кадра - _hd x _vd долей (размеры, сокращённые на НОД), так что деление одно на канал.
+// Fill - заполнить кадр с обрезкой по центру, Fit - вписать с чёрными полями, Stretch - растянуть
+
+class Resampler {
+   public:
+    typedef std::function<void(int x, int y, int w, int h, uint8_t* buf)> Callback;
+    enum class Mode : uint8_t {
+        Fill,
+        Fit,
+        Stretch,
+    };
+
+    ~Resampler() {
+        delete[] _acc;
+        delete[] _band;
+    }
+
+    // выделить буферы под кадр один раз: (w * 3 * 4 + w * 2 * RESAMPLER_BAND) байт
+    bool alloc(uint16_t w, uint16_t h) {
+        delete[] _acc;
+        delete[] _band;
+        _acc = new uint32_t[w * 3];
+        _band = new uint16_t[w * RESAMPLER_BAND];
+        _fw = (_acc && _band) ? w : 0;
+        _fh = _fw ? h : 0;
+        return _fw;
+    }
+
+    // ширина и высота кадра
+    uint16_t width() {
+        return _fw;
+    }
+    uint16_t height() {
+        return _fh;
+    }
+
+    // начать картинку sw x sh. Верхнее поле (Fit) выводится сразу
+    bool begin(uint16_t sw, uint16_t sh, Mode mode, bool swap, const Callback* cb) {
+        _active = false;
+        if (!_fw || !sw || !sh || !cb || !*cb) return false;
+        _swap = swap;
+        _cb = cb;
+        _sx = _sy = _dx = _dy = 0;
+        _sw = sw;
+        _sh = sh;
+        _rw = _fw;
+        _rh = _fh;
+        bool wider = (uint32_t)sw * _fh > (uint32_t)sh * _fw;
+        if (mode == Mode::Fill) {
+            if (wider) _sw = _div((uint32_t)sh * _fw, _fh);
+            else _sh = _div((uint32_t)sw * _fh, _fw);
+            _sx = (sw - _sw) / 2;
+            _sy = (sh - _sh) / 2;
+        } else if (mode == Mode::Fit) {
+            if (wider) _rh = _div((uint32_t)sh * _fw, sw);
+            else _rw = _div((uint32_t)sw * _fh, sh);
+            _dx = (_fw - _rw) / 2;
+            _dy = (_fh - _rh) / 2;
+        }
+        if (!_sw || !_sh || !_rw || !_rh) return false;
+
+        uint16_t g = _gcd(_sw, _rw);
+        _hs = _rw / g;
+        _hd = _sw / g;
+        g = _gcd(_sh, _rh);
+        _vs = _rh / g;
+        _vd = _sh / g;
+        uint32_t total = (uint32_t)_hd * _vd;
+        _inv = total <= 0xffff ? (1ul << 24) / total : 0;
+
+        _r = 0;
+        _by = 0;
+        _bn = 0;
+        memset(_acc, 0, _rw * 3 * 4);
+        memset(_band, 0, _fw * 2 * RESAMPLER_BAND);  // боковые поля (Fit) не пишутся
+        _active = true;
+        _bars(0, _dy);
+        return true;
+    }
+
+    // строки y..y+h картинки шириной sw (буфер с шагом stride пикселей)
+    void write(uint16_t y, uint16_t h, const uint8_t* buf, uint16_t stride) {
+        if (!_active) return;
+        const uint16_t* px = (const uint16_t*)buf;
+        for (uint16_t i = 0; i < h; i++, px += stride) {
+            uint16_t sy = y + i;
+            if (sy < _sy || sy >= _sy + _sh) continue;
+            // строка исходника занимает _vs долей по вертикали и может закрыть несколько строк кадра
+            uint32_t top = (uint32_t)(sy - _sy) * _vs;
+            uint32_t bot = top + _vs;
+            while (top < bot && _r < _rh) {
+                uint32_t rend = (uint32_t)(_r + 1) * _vd;
+                uint32_t end = min(bot, rend);
+                _add(px + _sx, end - top);
+                top = end;
+                if (end == rend) _emit();
+            }
+        }
+    }
+
+    // закончить картинку: нижнее поле (Fit) и неполная полоса
+    void end() {
+        if (!_active) return;
+        _active = false;
+        _bars(_dy + _rh, _fh);
+        _flush();
+    }
+
+    bool active() {
+        return _active;
+    }
+
+   private:
+    uint32_t* _acc = nullptr;  // суммы каналов R, G, B строки кадра
+    uint16_t* _band = nullptr;  // полоса кадра, RESAMPLER_BAND строк
+    const Callback* _cb = nullptr;
+    uint16_t _fw = 0, _fh = 0;  // кадр
+    uint16_t _sx, _sy, _sw, _sh;  // используемая область исходника
+    uint16_t _dx, _dy, _rw, _rh;  // область кадра под картинку
+    uint16_t _hs, _hd, _vs, _vd;  // доли исходного пикселя и пикселя кадра
+    uint32_t _inv;  // 2^24 / (_hd * _vd), 0 - делить
+    uint16_t _r;  // строка кадра в области картинки
+    uint16_t _by;  // строка кадра начала полосы
+    uint8_t _bn;  // строк в полосе
+    bool _swap = false;
+    bool _active = false;
+
+    static uint16_t _gcd(uint16_t a, uint16_t b) {
+        while (b) {
+            uint16_t t = a % b;
+            a = b;
+            b = t;
+        }
+        return a;
+    }
+    static uint16_t _div(uint32_t a, uint32_t b) {
+        return (a + b / 2) / b;
+    }
+
+    // добавить строку исходника с вертикальным весом vw
+    void _add(const uint16_t* px, uint32_t vw) {
+        uint32_t* acc = _acc;
+        uint32_t* last = _acc + _rw * 3;
+        uint32_t pos = 0, send = _hs, dend = _hd;
+        while (acc < last) {
+            uint32_t end = min(send, dend);
+            uint32_t w = (end - pos) * vw;
+            uint16_t c = *px;
+            if (_swap) c = (c >> 8) | (c << 8);
+            acc[0] += (c >> 11) * w;
+            acc[1] += ((c >> 5) & 0x3f) * w;
+            acc[2] += (c & 0x1f) * w;
+            pos = end;
+            if (end == send) {
+                px++;
+                send += _hs;
+            }
+            if (end == dend) {
+                acc += 3;
+                dend += _hd;
+            }
+        }
+    }
+
+    // строка кадра набрана - нормировать и отдать
+    void _emit() {
+        uint32_t* acc = _acc;
+        uint16_t* row = _band + _bn * _fw + _dx;
+        uint32_t total = (uint32_t)_hd * _vd;
+        for (uint16_t i = 0; i < _rw; i++, acc += 3) {
+            uint16_t r, g, b;
+            if (_inv) {
+                r = (acc[0] * _inv + (1ul << 23)) >> 24;
+                g = (acc[1] * _inv + (1ul << 23)) >> 24;
+                b = (acc[2] * _inv + (1ul << 23)) >> 24;
+            } else {
+                r = (acc[0] + total / 2) / total;
+                g = (acc[1] + total / 2) / total;
+                b = (acc[2] + total / 2) / total;
+            }
+            uint16_t c = (r << 11) | (g << 5) | b;
+            row[i] = _swap ? (c >> 8) | (c << 8) : c;
+        }
+        memset(_acc, 0, _rw * 3 * 4);
+        _r++;
+        _push();
+    }
+
+    // строка полосы готова
+    void _push() {
+        if (++_bn == RESAMPLER_BAND) _flush();
+    }
+
+    // отдать набранные строки полосы
+    void _flush() {
+        if (_bn) (*_cb)(0, _by, _fw, _bn, (uint8_t*)_band);
+        _by += _bn;
+        _bn = 0;
+    }
+
+    // чёрные строки кадра from..to. Картинка могла оборваться - поле выводится со своей строки
+    void _bars(uint16_t from, uint16_t to) {
+        if (from >= to) return;
+        _flush();
+        _by = from;
+        for (uint16_t y = from; y < to; y++) {
+            memset(_band + _bn * _fw, 0, _fw * 2);
+            _push();
+        }
+    }
+};
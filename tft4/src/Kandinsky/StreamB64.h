@@ -1,22 +1,89 @@
 #pragma once
 #include <Arduino.h>
-#include <StringUtils.h>
+
+// Потоковый декодер base64 из JSON строки: декодирует целыми четвёрками символов
+// прямо в буфер получателя, пропускает пробелы и JSON экранирование (\/ \n \r \t),
+// останавливается на закрывающей кавычке или '='.
+// Если поток умеет отдавать свой буфер (peek buffer API ядра ESP8266 3.x), base64
+// читается прямо из него без промежуточной копии.
+// Без ожидания (setWait(false)) readBytes() отдаёт то, что уже пришло, а ready() говорит, есть ли что отдать -
+// так декодер картинки идёт по tick и не стоит на таймауте потока
+
+#if defined(ESP8266) || defined(STREAM_PEEK_API)
+#define B64_PEEK_API
+#endif
 
 class StreamB64 {
+    enum : uint8_t {
+        B64_SKIP = 0x40,  // пробельные символы
+        B64_ESC = 0x41,   // '\'
+        B64_PAD = 0x42,   // '='
+        B64_END = 0x43,   // '"'
+        B64_BAD = 0x80,
+    };
+
    public:
-    StreamB64(Stream& stream, size_t bufsize = 512) : stream(stream), bufsize(bufsize) {
-        buffer = new uint8_t[bufsize];
+    StreamB64(Stream& stream, size_t bufsize = 512) : stream(stream), bufsize(bufsize & ~3) {
         stream.setTimeout(500);
     }
     ~StreamB64() {
+#ifdef B64_PEEK_API
+        if (_peeked) stream.peekConsume(_peeked - bufleft);
+#endif
         delete[] buffer;
     }
 
-    void readBytes(uint8_t* buf, size_t len) {
-        while (len--) {
-            uint8_t b = getByte();
-            if (buf) *buf++ = b;
+    // декодировать len байт в buf. Вернёт количество декодированных (меньше len в конце строки).
+    // buf == nullptr - пропустить len байт, четвёрки при этом только проверяются, но не декодируются
+    size_t readBytes(uint8_t* buf, size_t len) {
+        size_t left = len;
+        while (left) {
+            // остаток от прошлой четвёрки
+            if (_outlen) {
+                size_t n = min((size_t)_outlen, left);
+                if (buf) {
+                    memcpy(buf, _out + 3 - _outlen, n);
+                    buf += n;
+                }
+                _outlen -= n;
+                left -= n;
+                continue;
+            }
+            if (!_accn && !_esc && !_end) {
+                size_t n = buf ? _decodeQuads(buf, left) : _skipQuads(left);
+                if (buf) buf += n;
+                left -= n;
+                if (!left) break;
+            }
+            if (_end) break;
+            // ready() разбирает пришедшее до целой четвёрки. Без ожидания отдаём прочитанное, но первый байт ждём
+            if (!ready()) {
+                if (!_wait && left != len) break;
+                if (!_await()) _finish();
+            }
+        }
+        return len - left;
+    }
+
+    // строка закончилась (закрывающая кавычка, '=' или конец потока)
+    bool ended() {
+        return _end && !_outlen;
+    }
+
+    // ждать данные потока в readBytes() (по умолчанию). Без ожидания readBytes() возвращает меньше len, когда пришедшее
+    // кончилось, но первый байт ждёт до таймаута потока - для чтений ровно len (заголовок JPEG) ожидание нужно
+    void setWait(bool wait) {
+        _wait = wait;
+    }
+
+    // readBytes() отдаст хотя бы байт без ожидания или строка закончилась. Пришедшее разбирается до целой четвёрки:
+    // так не ждём остаток четвёрки после экранирования и видим конец строки, даже если за ним меньше четырёх символов.
+    // Поток может и не ждать в readBytes() (строка парсера без ожидания): пустое чтение при available() - не конец
+    bool ready() {
+        while (!_outlen && !_end && (bufleft || _arrived() > 0)) {
+            if (!_decodeChar()) break;
         }
+        return _outlen || _end;
     }
 
    private:
@@ -24,36 +91,204 @@ class StreamB64 {
     size_t bufsize;
 
     uint8_t* buffer = nullptr;
-    uint8_t* bufptr = nullptr;
+    const uint8_t* bufptr = nullptr;
     size_t bufleft = 0;
+    size_t _peeked = 0;  // размер взятого у потока буфера, ещё не отмеченного прочитанным
 
-    uint32_t val = 0;
-    int8_t valb = -8;
+    uint32_t _acc = 0;   // накопитель секстетов медленного пути
+    uint8_t _accn = 0;   // количество секстетов в накопителе
+    uint8_t _out[3];     // декодированная, но не выданная часть четвёрки
+    uint8_t _outlen = 0;
+    bool _esc = false;
+    bool _end = false;
+    bool _wait = true;
 
-    uint8_t getByte() {
-        uint8_t b = 0;
-        while (valb < 0) {
-            char c = 0;
+    static const uint8_t _table[256];
 
-            if (buffer) {
-                if (!bufleft) {
-                    bufleft = stream.readBytes(buffer, bufsize);
-                    bufptr = buffer;
-                }
-                c = *bufptr;
-                bufptr++;
-                bufleft--;
+    // быстрый путь: целые четвёрки без служебных символов прямо в буфер получателя. Вернёт количество байт
+    size_t _decodeQuads(uint8_t* p, size_t len) {
+        const uint8_t* t = _table;
+        const uint8_t* s = bufptr;
+        size_t quads = min(bufleft >> 2, len / 3);
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        // SWAR: четвёрка символов одним 32-битным словом. Невыровненный источник (буфер TLS)
+        // собирается из двух выровненных слов сдвигом, чтение не выходит за слово с последним символом
+        uint8_t sh = ((uintptr_t)s & 3) * 8;
+        const uint8_t* a = s - ((uintptr_t)s & 3);
+        uint32_t lo = 0;
+        if (sh && quads) memcpy(&lo, __builtin_assume_aligned(a, 4), 4);
+#endif
+        while (quads) {
+            uint8_t c0, c1, c2, c3;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            uint32_t w;
+            if (sh) {
+                uint32_t hi;
+                memcpy(&hi, __builtin_assume_aligned(a + 4, 4), 4);
+                w = (lo >> sh) | (hi << (32 - sh));
+                lo = hi;
+            } else {
+                memcpy(&w, __builtin_assume_aligned(a, 4), 4);
             }
+            a += 4;
+            c0 = t[w & 0xff];
+            c1 = t[(w >> 8) & 0xff];
+            c2 = t[(w >> 16) & 0xff];
+            c3 = t[w >> 24];
+#else
+            c0 = t[s[0]];
+            c1 = t[s[1]];
+            c2 = t[s[2]];
+            c3 = t[s[3]];
+#endif
+            if ((c0 | c1 | c2 | c3) & 0xC0) break;  // служебный символ - медленный путь
+
+            uint32_t v = ((uint32_t)c0 << 18) | ((uint32_t)c1 << 12) | ((uint32_t)c2 << 6) | c3;
+            p[0] = v >> 16;
+            p[1] = v >> 8;
+            p[2] = v;
+            p += 3;
+            s += 4;
+            quads--;
+        }
+        size_t n = s - bufptr;
+        bufleft -= n;
+        bufptr = s;
+        return n / 4 * 3;
+    }
+
+    // пропуск целых четвёрок: только проверка символов по таблице. Вернёт количество байт
+    size_t _skipQuads(size_t len) {
+        const uint8_t* t = _table;
+        const uint8_t* s = bufptr;
+        size_t quads = min(bufleft >> 2, len / 3);
 
-            if (c == '=') return b;
-            val = (val << 6) + su::b64::getByte(c);
-            valb += 6;
-            if (valb >= 0) {
-                b = (val >> valb) & 0xFF;
-                valb -= 8;
-                break;
+        while (quads) {
+            if ((t[s[0]] | t[s[1]] | t[s[2]] | t[s[3]]) & 0xC0) break;
+            s += 4;
+            quads--;
+        }
+        size_t n = s - bufptr;
+        bufleft -= n;
+        bufptr = s;
+        return n / 4 * 3;
+    }
+
+    // взять следующую порцию base64 из потока. Вернёт false, если данных нет
+    bool _refill() {
+#ifdef B64_PEEK_API
+        if (stream.hasPeekBufferAPI()) {
+            if (_peeked) stream.peekConsume(_peeked);
+            _peeked = 0;
+            uint32_t tmr = millis();
+            while (!stream.peekAvailable()) {
+                if (!stream.hasPeekBufferAPI()) break;  // поток перестал отдавать буфер - читаем копией
+                if (millis() - tmr >= stream.getTimeout()) return false;
+                stream.available();  // прокачать TLS
+                delay(0);
             }
+            if (stream.hasPeekBufferAPI()) {
+                _peeked = bufleft = stream.peekAvailable();
+                bufptr = (const uint8_t*)stream.peekBuffer();
+                return true;
+            }
+        }
+#endif
+        if (!buffer) buffer = new uint8_t[bufsize];
+        int av = stream.available();
+        bufleft = buffer ? stream.readBytes(buffer, av > 0 && (size_t)av < bufsize ? av : bufsize) : 0;
+        bufptr = buffer;
+        return bufleft;
+    }
+
+    // пришло в поток сверх разобранного: взятый у потока буфер отдаётся, иначе available() посчитает и его
+    int _arrived() {
+#ifdef B64_PEEK_API
+        if (_peeked) stream.peekConsume(_peeked);
+        _peeked = 0;
+#endif
+        return stream.available();
+    }
+
+    // ждать ready() не дольше таймаута потока
+    bool _await() {
+        uint32_t tmr = millis();
+        while (!ready()) {
+            if (millis() - tmr >= stream.getTimeout()) return false;
+            delay(1);
         }
-        return b;
+        return true;
     }
-};
\ No newline at end of file
+
+    // медленный путь: один символ. Вернёт false, если строка закончилась или символ ещё не пришёл
+    bool _decodeChar() {
+        if (_end) return false;
+        if (!bufleft && !_refill()) return stream.available() > 0 ? false : _finish();
+        uint8_t c = *bufptr++;
+        bufleft--;
+
+        if (_esc) {
+            _esc = false;
+            if (c != '/') return true;  // \n \r \t и прочее экранирование пропускаем
+        }
+        uint8_t v = _table[c];
+        switch (v) {
+            case B64_SKIP:
+                return true;
+            case B64_ESC:
+                _esc = true;
+                return true;
+            case B64_PAD:
+            case B64_END:
+            case B64_BAD:
+                return _finish();
+        }
+        _acc = (_acc << 6) | v;
+        if (++_accn == 4) {
+            _out[0] = _acc >> 16;
+            _out[1] = _acc >> 8;
+            _out[2] = _acc;
+            _outlen = 3;
+            _acc = _accn = 0;
+        }
+        return true;
+    }
+
+    // выдать неполную четвёрку в конце строки
+    bool _finish() {
+        _end = true;
+        if (_accn >= 2) {
+            uint32_t v = _acc << (6 * (4 - _accn));
+            uint8_t n = _accn - 1;
+            _out[0] = v >> 16;
+            _out[1] = v >> 8;
+            _out[2] = v;
+            // выравниваем под чтение _out[3 - _outlen]
+            for (uint8_t i = n; i--;) _out[3 - n + i] = _out[i];
+            _outlen = n;
+        }
+        _acc = _accn = 0;
+        return _outlen;
+    }
+};
+
+// таблица в RAM (256 байт) - на ESP8266 чтение из PROGMEM медленнее
+const uint8_t StreamB64::_table[256] __attribute__((weak, aligned(4))) = {
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x40, 0x40, 0x80, 0x80, 0x40, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x40, 0x80, 0x43, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 62, 0x80, 0x80, 0x80, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 0x80, 0x80, 0x80, 0x42, 0x80, 0x80,
+    0x80, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 0x80, 0x41, 0x80, 0x80, 0x80,
+    0x80, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+};
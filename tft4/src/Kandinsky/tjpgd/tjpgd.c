@@ -22,6 +22,9 @@
 / Jun 11, 2021 R0.02a Some performance improvement.
 / Jul 01, 2021 R0.03  Added JD_FASTDECODE option.
 /                     Some performance improvement.
+/ (local)             Reduced-size IDCT and AC skipping for 1/2, 1/4 and 1/8 output scaling.
+/                     JD_FASTDECODE 2 falls back to mode 1 if the pool is too small for LUTs.
+/                     Added jd_decomp_init/jd_decomp_mcus to decompress a few MCUs per call.
 /----------------------------------------------------------------------------*/
 
 #include "tjpgd.h"
@@ -236,7 +239,7 @@ static JRESULT create_huffman_tbl (	/* 0:OK, !0:Failed */
 			pd[i] = d;
 		}
 #if JD_FASTDECODE == 2
-		{	/* Create fast huffman decode table */
+		if (jd->fastlut) {	/* Create fast huffman decode table */
 			unsigned int span, td, ti;
 			uint16_t *tbl_ac = 0;
 			uint8_t *tbl_dc = 0;
@@ -367,34 +370,37 @@ static int huffext (	/* >=0: decoded data, <0: error code */
 	jd->wreg = w;
 
 #if JD_FASTDECODE == 2
-	/* Table serch for the short codes */
-	d = (unsigned int)(w >> (wbit - HUFF_BIT));	/* Short code as table index */
-	if (cls) {	/* AC element */
-		d = jd->hufflut_ac[id][d];	/* Table decode */
-		if (d != 0xFFFF) {	/* It is done if hit in short code */
-			jd->dbit = wbit - (d >> 8);	/* Snip the code length */
-			return d & 0xFF;	/* b7..0: zero run and following data bits */
-		}
-	} else {	/* DC element */
-		d = jd->hufflut_dc[id][d];	/* Table decode */
-		if (d != 0xFF) {	/* It is done if hit in short code */
-			jd->dbit = wbit - (d >> 4);	/* Snip the code length  */
-			return d & 0xF;	/* b3..0: following data bits */
+	if (jd->fastlut) {
+		/* Table serch for the short codes */
+		d = (unsigned int)(w >> (wbit - HUFF_BIT));	/* Short code as table index */
+		if (cls) {	/* AC element */
+			d = jd->hufflut_ac[id][d];	/* Table decode */
+			if (d != 0xFFFF) {	/* It is done if hit in short code */
+				jd->dbit = wbit - (d >> 8);	/* Snip the code length */
+				return d & 0xFF;	/* b7..0: zero run and following data bits */
+			}
+		} else {	/* DC element */
+			d = jd->hufflut_dc[id][d];	/* Table decode */
+			if (d != 0xFF) {	/* It is done if hit in short code */
+				jd->dbit = wbit - (d >> 4);	/* Snip the code length  */
+				return d & 0xF;	/* b3..0: following data bits */
+			}
 		}
-	}
 
-	/* Incremental serch for the codes longer than HUFF_BIT */
-	hb = jd->huffbits[id][cls] + HUFF_BIT;				/* Bit distribution table */
-	hc = jd->huffcode[id][cls] + jd->longofs[id][cls];	/* Code word table */
-	hd = jd->huffdata[id][cls] + jd->longofs[id][cls];	/* Data table */
-	bl = HUFF_BIT + 1;
-#else
-	/* Incremental serch for all codes */
-	hb = jd->huffbits[id][cls];	/* Bit distribution table */
-	hc = jd->huffcode[id][cls];	/* Code word table */
-	hd = jd->huffdata[id][cls];	/* Data table */
-	bl = 1;
+		/* Incremental serch for the codes longer than HUFF_BIT */
+		hb = jd->huffbits[id][cls] + HUFF_BIT;				/* Bit distribution table */
+		hc = jd->huffcode[id][cls] + jd->longofs[id][cls];	/* Code word table */
+		hd = jd->huffdata[id][cls] + jd->longofs[id][cls];	/* Data table */
+		bl = HUFF_BIT + 1;
+	} else
 #endif
+	{
+		/* Incremental serch for all codes */
+		hb = jd->huffbits[id][cls];	/* Bit distribution table */
+		hc = jd->huffcode[id][cls];	/* Code word table */
+		hd = jd->huffdata[id][cls];	/* Data table */
+		bl = 1;
+	}
 	for ( ; bl <= 16; bl++) {	/* Incremental search */
 		nc = *hb++;
 		if (nc) {
@@ -694,20 +700,124 @@ static void block_idct (
 
 
 
+#if JD_USE_SCALE
+/*-----------------------------------------------------------------------*/
+/* Apply reduced-size Inverse-DCT for 1/2 and 1/4 output scaling         */
+/*-----------------------------------------------------------------------*/
+/* Only the low-frequency NxN corner of the block is used and the block  */
+/* is stored as NxN pixels (row stride N). The coefficients are          */
+/* pre-scaled for the Arai algorithm, so the constants below include the */
+/* inverse of that scale factor: cos((2k+1)u*pi/2N) / cos(u*pi/16).      */
+
+static void block_idct4 (
+	int32_t* src,	/* Input block data (de-quantized and pre-scaled for Arai Algorithm) */
+	jd_yuv_t* dst	/* Pointer to the destination to store the 4x4 block */
+)
+{
+	const int32_t C2 = (int32_t)(0.76537*4096), C1A = (int32_t)(0.94197*4096), C1B = (int32_t)(0.39018*4096), C3A = (int32_t)(0.46024*4096), C3B = (int32_t)(1.11114*4096);
+	int32_t e0, e1, o0, o1;
+	int i;
+
+	/* Process columns */
+	for (i = 0; i < 4; i++) {
+		e0 = src[8 * 0] + (src[8 * 2] * C2 >> 12);	/* Even elements */
+		e1 = src[8 * 0] - (src[8 * 2] * C2 >> 12);
+		o0 = (src[8 * 1] * C1A + src[8 * 3] * C3A) >> 12;	/* Odd elements */
+		o1 = (src[8 * 1] * C1B - src[8 * 3] * C3B) >> 12;
+
+		src[8 * 0] = e0 + o0;	/* Write-back transformed values */
+		src[8 * 3] = e0 - o0;
+		src[8 * 1] = e1 + o1;
+		src[8 * 2] = e1 - o1;
+
+		src++;	/* Next column */
+	}
+
+	/* Process rows */
+	src -= 4;
+	for (i = 0; i < 4; i++) {
+		e0 = src[0] + (128L << 8);	/* Remove DC offset (-128) here */
+		e1 = e0 - (src[2] * C2 >> 12);
+		e0 += src[2] * C2 >> 12;
+		o0 = (src[1] * C1A + src[3] * C3A) >> 12;
+		o1 = (src[1] * C1B - src[3] * C3B) >> 12;
+
+		/* Descale the transformed values 8 bits and output a row */
+#if JD_FASTDECODE >= 1
+		dst[0] = (int16_t)((e0 + o0) >> 8);
+		dst[3] = (int16_t)((e0 - o0) >> 8);
+		dst[1] = (int16_t)((e1 + o1) >> 8);
+		dst[2] = (int16_t)((e1 - o1) >> 8);
+#else
+		dst[0] = BYTECLIP((e0 + o0) >> 8);
+		dst[3] = BYTECLIP((e0 - o0) >> 8);
+		dst[1] = BYTECLIP((e1 + o1) >> 8);
+		dst[2] = BYTECLIP((e1 - o1) >> 8);
+#endif
+
+		dst += 4; src += 8;	/* Next row */
+	}
+}
+
+
+static void block_idct2 (
+	int32_t* src,	/* Input block data (de-quantized and pre-scaled for Arai Algorithm) */
+	jd_yuv_t* dst	/* Pointer to the destination to store the 2x2 block */
+)
+{
+	const int32_t C1 = (int32_t)(0.72096*4096);
+	int32_t v0, v1, v2, v3;
+
+	v0 = src[0] + (128L << 8);	/* Columns (DC offset is removed here) */
+	v1 = src[8] * C1 >> 12;
+	v2 = src[1];
+	v3 = src[9] * C1 >> 12;
+
+	src[0] = v0 + v1;	/* Rows */
+	src[8] = v0 - v1;
+	src[1] = (v2 + v3) * C1 >> 12;
+	src[9] = (v2 - v3) * C1 >> 12;
+
+#if JD_FASTDECODE >= 1
+	dst[0] = (int16_t)((src[0] + src[1]) >> 8);
+	dst[1] = (int16_t)((src[0] - src[1]) >> 8);
+	dst[2] = (int16_t)((src[8] + src[9]) >> 8);
+	dst[3] = (int16_t)((src[8] - src[9]) >> 8);
+#else
+	dst[0] = BYTECLIP((src[0] + src[1]) >> 8);
+	dst[1] = BYTECLIP((src[0] - src[1]) >> 8);
+	dst[2] = BYTECLIP((src[8] + src[9]) >> 8);
+	dst[3] = BYTECLIP((src[8] - src[9]) >> 8);
+#endif
+}
+#endif
+
+
+
 
 /*-----------------------------------------------------------------------*/
 /* Load all blocks in an MCU into working buffer                         */
 /*-----------------------------------------------------------------------*/
 
+#ifdef JD_REF_IDCT
+void JD_REF_IDCT (int32_t* src, jd_yuv_t* dst, unsigned int n);	/* NxN IDCT in floating point instead of block_idct* (host bench reference, tft4/bench/ref_tjpgd.c) */
+#endif
+
 static JRESULT mcu_load (
 	JDEC* jd		/* Pointer to the decompressor object */
 )
 {
 	int32_t *tmp = (int32_t*)jd->workbuf;	/* Block working buffer for de-quantize and IDCT */
 	int d, e;
-	unsigned int blk, nby, i, bc, z, id, cmp;
+	unsigned int blk, nby, i, bc, z, id, cmp, ac;
 	jd_yuv_t *bp;
 	const int32_t *dqf;
+#if JD_USE_SCALE
+	static const uint8_t Skip[4] = {0x00, 0x24, 0x36, 0x3F};	/* Raster index bits of the AC elements out of the NxN corner for each scale */
+	unsigned int skip = Skip[jd->scale & 3], n = 8 >> jd->scale;
+#else
+	const unsigned int skip = 0, n = 8;
+#endif
 
 
 	nby = jd->msx * jd->msy;	/* Number of Y blocks (1, 2 or 4) */
@@ -739,7 +849,12 @@ static JRESULT mcu_load (
 			tmp[0] = d * dqf[0] >> 8;				/* De-quantize, apply scale factor of Arai algorithm and descale 8 bits */
 
 			/* Extract following 63 AC elements from input stream */
-			memset(&tmp[1], 0, 63 * sizeof (int32_t));	/* Initialize all AC elements */
+			if (n == 8) {
+				memset(&tmp[1], 0, 63 * sizeof (int32_t));	/* Initialize all AC elements */
+			} else {
+				for (i = 0; i < n; i++) memset(&tmp[i * 8 + !i], 0, (n - !i) * sizeof (int32_t));	/* Initialize only AC elements in the NxN corner */
+			}
+			ac = 0;		/* No AC element is stored */
 			z = 1;		/* Top of the AC elements (in zigzag-order) */
 			do {
 				d = huffext(jd, id, 1);				/* Extract a huffman coded value (zero runs and bit length) */
@@ -754,20 +869,33 @@ static JRESULT mcu_load (
 					bc = 1 << (bc - 1);				/* MSB position */
 					if (!(d & bc)) d -= (bc << 1) - 1;	/* Restore negative value if needed */
 					i = Zig[z];						/* Get raster-order index */
-					tmp[i] = d * dqf[i] >> 8;		/* De-quantize, apply scale factor of Arai algorithm and descale 8 bits */
+					if (!(i & skip)) {				/* Drop high frequencies that are not needed for the scaled output */
+						tmp[i] = d * dqf[i] >> 8;	/* De-quantize, apply scale factor of Arai algorithm and descale 8 bits */
+						ac = 1;
+					}
 				}
 			} while (++z < 64);		/* Next AC element */
 
 			if (JD_FORMAT != 2 || !cmp) {	/* C components may not be processed if in grayscale output */
-				if (z == 1 || (JD_USE_SCALE && jd->scale == 3)) {	/* If no AC element or scale ratio is 1/8, IDCT can be ommited and the block is filled with DC value */
+				if (!ac) {	/* If no AC element (always at scale ratio 1/8), IDCT can be ommited and the block is filled with DC value */
 					d = (jd_yuv_t)((*tmp / 256) + 128);
 					if (JD_FASTDECODE >= 1) {
-						for (i = 0; i < 64; bp[i++] = d) ;
+						for (i = 0; i < n * n; bp[i++] = d) ;
 					} else {
-						memset(bp, d, 64);
+						memset(bp, d, n * n);
 					}
 				} else {
+#if defined(JD_REF_IDCT)
+					JD_REF_IDCT(tmp, bp, n);
+#elif JD_USE_SCALE
+					switch (jd->scale) {	/* Apply IDCT of the output size and store the block to the MCU buffer */
+					case 1: block_idct4(tmp, bp); break;
+					case 2: block_idct2(tmp, bp); break;
+					default: block_idct(tmp, bp);
+					}
+#else
 					block_idct(tmp, bp);	/* Apply IDCT and store the block to the MCU buffer */
+#endif
 				}
 			}
 		}
@@ -812,7 +940,7 @@ static JRESULT mcu_output (
 	rect.top = y; rect.bottom = y + ry - 1;
 
 
-	if (!JD_USE_SCALE || jd->scale != 3) {	/* Not for 1/8 scaling */
+	if (!JD_USE_SCALE || !jd->scale) {	/* Not scaled */
 		pix = (uint8_t*)jd->workbuf;
 
 		if (JD_FORMAT != 2) {	/* RGB output (build an RGB MCU from Y/C component) */
@@ -859,39 +987,30 @@ static JRESULT mcu_output (
 			}
 		}
 
-		/* Descale the MCU rectangular if needed */
-		if (JD_USE_SCALE && jd->scale) {
-			unsigned int x, y, r, g, b, s, w, a;
-			uint8_t *op;
-
-			/* Get averaged RGB value of each square correcponds to a pixel */
-			s = jd->scale * 2;	/* Number of shifts for averaging */
-			w = 1 << jd->scale;	/* Width of square */
-			a = (mx - w) * (JD_FORMAT != 2 ? 3 : 1);	/* Bytes to skip for next line in the square */
-			op = (uint8_t*)jd->workbuf;
-			for (iy = 0; iy < my; iy += w) {
-				for (ix = 0; ix < mx; ix += w) {
-					pix = (uint8_t*)jd->workbuf + (iy * mx + ix) * (JD_FORMAT != 2 ? 3 : 1);
-					r = g = b = 0;
-					for (y = 0; y < w; y++) {	/* Accumulate RGB value in the square */
-						for (x = 0; x < w; x++) {
-							r += *pix++;	/* Accumulate R or Y (monochrome output) */
-							if (JD_FORMAT != 2) {	/* RGB output? */
-								g += *pix++;	/* Accumulate G */
-								b += *pix++;	/* Accumulate B */
-							}
-						}
-						pix += a;
-					}							/* Put the averaged pixel value */
-					*op++ = (uint8_t)(r >> s);	/* Put R or Y (monochrome output) */
-					if (JD_FORMAT != 2) {	/* RGB output? */
-						*op++ = (uint8_t)(g >> s);	/* Put G */
-						*op++ = (uint8_t)(b >> s);	/* Put B */
-					}
+#if JD_USE_SCALE
+	} else if (jd->scale != 3) {	/* For 1/2 and 1/4 scaling (blocks are already NxN pixels after reduced IDCT) */
+		unsigned int n = 8 >> jd->scale, sh = 3 - jd->scale, smx = mx >> jd->scale, smy = my >> jd->scale;
+		unsigned int c;
+
+		pix = (uint8_t*)jd->workbuf;
+		for (iy = 0; iy < smy; iy++) {
+			py = jd->mcubuf + (iy >> sh) * jd->msx * 64 + (iy & (n - 1)) * n;	/* Row in the Y block */
+			pc = jd->mcubuf + jd->msx * jd->msy * 64 + (my == 16 ? iy >> 1 : iy) * n;	/* Row in the C block */
+			for (ix = 0; ix < smx; ix++) {
+				yy = py[(ix >> sh) * 64 + (ix & (n - 1))];	/* Get Y component */
+				if (JD_FORMAT != 2) {	/* RGB output */
+					c = (mx == 16) ? ix >> 1 : ix;
+					cb = pc[c] - 128;	/* Get Cb/Cr component and remove offset */
+					cr = pc[c + 64] - 128;
+					*pix++ = /*R*/ BYTECLIP(yy + ((int)(1.402 * CVACC) * cr) / CVACC);
+					*pix++ = /*G*/ BYTECLIP(yy - ((int)(0.344 * CVACC) * cb + (int)(0.714 * CVACC) * cr) / CVACC);
+					*pix++ = /*B*/ BYTECLIP(yy + ((int)(1.772 * CVACC) * cb) / CVACC);
+				} else {	/* Monochrome output */
+					*pix++ = (JD_FASTDECODE >= 1) ? BYTECLIP(yy) : yy;
 				}
 			}
 		}
-
+#endif
 	} else {	/* For only 1/8 scaling (left-top pixel in each block are the DC value of the block) */
 
 		/* Build a 1/8 descaled RGB MCU from discrete comopnents */
@@ -996,6 +1115,9 @@ JRESULT jd_prepare (
 	jd->infunc = infunc;	/* Stream input function */
 	jd->device = dev;		/* I/O device identifier */
   jd->swap = tmp; // Restore the swap flag
+#if JD_FASTDECODE == 2
+	jd->fastlut = sz_pool >= TJPGD_WORKSPACE_SIZE_LUT;	/* Build fast huffman decode tables only if the pool is large enough for them */
+#endif
 
 	jd->inbuf = seg = alloc_pool(jd, JD_SZBUF);		/* Allocate stream input buffer */
 	if (!seg) return JDR_MEM1;
@@ -1132,39 +1254,79 @@ JRESULT jd_prepare (
 /* Start to decompress the JPEG picture                                  */
 /*-----------------------------------------------------------------------*/
 
-JRESULT jd_decomp (
+JRESULT jd_decomp_init (
 	JDEC* jd,								/* Initialized decompression object */
-	int (*outfunc)(JDEC*, void*, JRECT*),	/* RGB output function */
 	uint8_t scale							/* Output de-scaling factor (0 to 3) */
 )
 {
-	unsigned int x, y, mx, my;
-	uint16_t rst, rsc;
-	JRESULT rc;
-
-
 	if (scale > (JD_USE_SCALE ? 3 : 0)) return JDR_PAR;
 	jd->scale = scale;
 
-	mx = jd->msx * 8; my = jd->msy * 8;			/* Size of the MCU (pixel) */
-
 	jd->dcv[2] = jd->dcv[1] = jd->dcv[0] = 0;	/* Initialize DC values */
-	rst = rsc = 0;
+	jd->rst = jd->rsc = 0;
+	jd->mcux = jd->mcuy = 0;
+
+	return JDR_OK;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Decompress next MCUs (jd->mcuy >= jd->height when done)              */
+/*-----------------------------------------------------------------------*/
+
+JRESULT jd_decomp_mcus (
+	JDEC* jd,								/* Decompression object started by jd_decomp_init */
+	int (*outfunc)(JDEC*, void*, JRECT*),	/* RGB output function */
+	unsigned int n							/* Number of MCUs to decompress */
+)
+{
+	unsigned int mx, my;
+	JRESULT rc;
+
+
+	mx = jd->msx * 8; my = jd->msy * 8;			/* Size of the MCU (pixel) */
 
 	rc = JDR_OK;
-	for (y = 0; y < jd->height; y += my) {		/* Vertical loop of MCUs */
-		for (x = 0; x < jd->width; x += mx) {	/* Horizontal loop of MCUs */
-			if (jd->nrst && rst++ == jd->nrst) {	/* Process restart interval if enabled */
-				rc = restart(jd, rsc++);
-				if (rc != JDR_OK) return rc;
-				rst = 1;
-			}
-			rc = mcu_load(jd);					/* Load an MCU (decompress huffman coded stream, dequantize and apply IDCT) */
-			if (rc != JDR_OK) return rc;
-			rc = mcu_output(jd, outfunc, x, y);	/* Output the MCU (YCbCr to RGB, scaling and output) */
+	for ( ; n && jd->mcuy < jd->height; n--) {	/* MCUs in raster order */
+		if (jd->nrst && jd->rst++ == jd->nrst) {	/* Process restart interval if enabled */
+			rc = restart(jd, jd->rsc++);
 			if (rc != JDR_OK) return rc;
+			jd->rst = 1;
+		}
+		rc = mcu_load(jd);						/* Load an MCU (decompress huffman coded stream, dequantize and apply IDCT) */
+		if (rc != JDR_OK) return rc;
+		rc = mcu_output(jd, outfunc, jd->mcux, jd->mcuy);	/* Output the MCU (YCbCr to RGB, scaling and output) */
+		if (rc != JDR_OK) return rc;
+		jd->mcux += mx;
+		if (jd->mcux >= jd->width) {			/* Next row of MCUs */
+			jd->mcux = 0;
+			jd->mcuy += my;
 		}
 	}
 
 	return rc;
 }
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Decompress the whole JPEG picture                                     */
+/*-----------------------------------------------------------------------*/
+
+JRESULT jd_decomp (
+	JDEC* jd,								/* Initialized decompression object */
+	int (*outfunc)(JDEC*, void*, JRECT*),	/* RGB output function */
+	uint8_t scale							/* Output de-scaling factor (0 to 3) */
+)
+{
+	JRESULT rc;
+
+
+	rc = jd_decomp_init(jd, scale);
+	if (rc != JDR_OK) return rc;
+
+	return jd_decomp_mcus(jd, outfunc, (unsigned int)-1);
+}
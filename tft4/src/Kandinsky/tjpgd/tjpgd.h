@@ -66,6 +66,8 @@ struct JDEC {
 	uint8_t ncomp;				/* Number of color components 1:grayscale, 3:color */
 	int16_t dcv[3];				/* Previous DC element of each component */
 	uint16_t nrst;				/* Restart inverval */
+	uint16_t rst, rsc;			/* Restart interval counter and next RST marker number */
+	uint16_t mcux, mcuy;		/* Position of the next MCU to decompress */
 	uint16_t width, height;		/* Size of the input image (pixel) */
 	uint8_t* huffbits[2][2];	/* Huffman bit distribution tables [id][dcac] */
 	uint16_t* huffcode[2][2];	/* Huffman code word tables [id][dcac] */
@@ -75,6 +77,7 @@ struct JDEC {
 	uint32_t wreg;				/* Working shift register */
 	uint8_t marker;				/* Detected marker (0:None) */
 #if JD_FASTDECODE == 2
+	uint8_t fastlut;			/* Fast huffman decode tables are used (1: workspace is large enough) */
 	uint8_t longofs[2][2];		/* Table offset of long code [id][dcac] */
 	uint16_t* hufflut_ac[2];	/* Fast huffman decode tables for AC short code [id] */
 	uint8_t* hufflut_dc[2];		/* Fast huffman decode tables for DC short code [id] */
@@ -94,6 +97,8 @@ struct JDEC {
 /* TJpgDec API functions */
 JRESULT jd_prepare (JDEC* jd, size_t (*infunc)(JDEC*,uint8_t*,size_t), void* pool, size_t sz_pool, void* dev);
 JRESULT jd_decomp (JDEC* jd, int (*outfunc)(JDEC*,void*,JRECT*), uint8_t scale);
+JRESULT jd_decomp_init (JDEC* jd, uint8_t scale);
+JRESULT jd_decomp_mcus (JDEC* jd, int (*outfunc)(JDEC*,void*,JRECT*), unsigned int n);
 
 
 #ifdef __cplusplus
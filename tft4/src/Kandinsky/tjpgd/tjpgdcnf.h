@@ -24,14 +24,15 @@
 /  1: Enable
 */
 
-#define JD_FASTDECODE	1
+#define JD_FASTDECODE	2
 /* Optimization level
 /  0: Basic optimization. Suitable for 8/16-bit MCUs.
 /     Workspace of 3100 bytes needed.
 /  1: + 32-bit barrel shifter. Suitable for 32-bit MCUs.
 /     Workspace of 3480 bytes needed.
 /  2: + Table conversion for huffman decoding (wants 6 << HUFF_BIT bytes of RAM).
-/     Workspace of 9644 bytes needed.
+/     Workspace of 9644 bytes needed. With a smaller workspace (at least 3500 bytes)
+/     tables are not built and the decoder works as in mode 1.
 */
 
 // Do not change this, it is the minimum size in bytes of the workspace needed by the decoder
@@ -40,5 +41,6 @@
 #elif JD_FASTDECODE == 1
  #define TJPGD_WORKSPACE_SIZE 3500
 #elif JD_FASTDECODE == 2
- #define TJPGD_WORKSPACE_SIZE (3500 + 6144)
+ #define TJPGD_WORKSPACE_SIZE 3500
+ #define TJPGD_WORKSPACE_SIZE_LUT (3500 + 6144)
 #endif
\ No newline at end of file
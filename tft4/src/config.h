@@ -3,4 +3,10 @@
 #define F_VERSION "1.1"
 #define DISP_WIDTH 320
 #define DISP_HEIGHT 480
-#define DISP_SCALE 4    // 1, 2, 4, 8
\ No newline at end of file
+#define GEN_WIDTH 384   // размер генерации: наименьший кратный 64 с пропорцией экрана и не меньше экрана.
+#define GEN_HEIGHT 576  // В экран картинка масштабируется при выводе (Kandinsky::setFrame)
+#define GEN_BATCH 3  // картинок за одну генерацию про запас (не больше FUSION_RING), API вызывается, когда кольцо пусто
+#define GEN_PREFETCH_RETRY 60000  // пауза между заказами картинки про запас (при ошибке), мс
+#define GAL_DIR "/gal"       // галерея показанных картинок для работы без сети
+#define GAL_RESERVE 32768   // свободное место сверх кольца запаса, которое галерея не занимает, байт
+#define GAL_SLICE 20        // время копирования картинки в галерею за один gal_tick, мс
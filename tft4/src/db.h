@@ -13,6 +13,7 @@ enum kk : size_t {
     gen_style,
     auto_gen,
     auto_prd,
+    gal_head,
 };
 
 void db_init() {
@@ -29,4 +30,6 @@ void db_init() {
 
     db.init(kk::auto_gen, 0);
     db.init(kk::auto_prd, 60);
+
+    db.init(kk::gal_head, 0);
 }
\ No newline at end of file
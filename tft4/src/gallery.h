@@ -0,0 +1,151 @@
+#pragma once
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <TableFile.h>
+
+#include "Kandinsky/Kandinsky.h"
+#include "config.h"
+#include "db.h"
+
+// офлайн-галерея: копии показанных картинок во флеше (GAL_DIR/<номер>.jpg) и их индекс в таблице.
+// Показ идёт по кругу с головы gal_head, после показа голова сдвигается на следующую строку,
+// строки таблицы не переставляются. Когда не хватает места, вытесняется голова: это очередь (FIFO)
+// по кругу показа, а не по давности показа - новые картинки добавляются в конец таблицы
+// и могут стоять в круге раньше показанных давно
+
+enum gal_col : uint8_t {
+    gal_id,      // номер файла
+    gal_prompt,  // хеш промта
+    gal_style,   // стиль
+    gal_time,    // время генерации (unix, 0 - время не синхронизировано)
+    gal_size,    // размер файла
+};
+
+TableFile gal(&LittleFS, GAL_DIR ".tbl", 5000);
+uint16_t gal_next_id = 0;
+uint16_t gal_head = 0;  // строка следующей для показа (хранится в db)
+
+// копия новой картинки по кускам из gal_tick
+struct {
+    File src;
+    File dst;
+    uint32_t left = 0;
+    uint32_t size = 0;
+    uint32_t prompt = 0;
+    uint32_t time = 0;
+    uint16_t id = 0;
+    char style[17];
+} gal_copy;
+
+String gal_path(uint16_t id) {
+    return String(GAL_DIR "/") + String(id) + ".jpg";
+}
+
+size_t gal_free() {
+#ifdef ESP8266
+    FSInfo info;
+    if (!LittleFS.info(info)) return 0;
+    return info.totalBytes - info.usedBytes;
+#else
+    return LittleFS.totalBytes() - LittleFS.usedBytes();
+#endif
+}
+
+void gal_init() {
+    gal.begin();
+    gal.init(5, cell_t::Uint16, cell_t::Uint32, cell_t::Char16, cell_t::Unix, cell_t::Uint32);
+    LittleFS.mkdir(GAL_DIR);
+    gal_next_id = 0;
+    for (uint16_t i = 0; i < gal.rows(); i++) {
+        uint16_t id = gal[i][gal_id];
+        if (id >= gal_next_id) gal_next_id = id + 1;
+    }
+    gal_head = db[kk::gal_head].toInt();
+    if (gal_head >= gal.rows()) gal_head = 0;
+}
+
+// убрать строку (вытеснение или битый файл): голова остаётся на том же месте круга
+void gal_remove(uint16_t row) {
+    gal.remove(row);
+    if (row < gal_head) gal_head--;
+    if (gal_head >= gal.rows()) gal_head = 0;
+    db.set(kk::gal_head, gal_head);
+}
+
+// вытеснять с головы (следующие по кругу), пока свободно меньше need байт
+void gal_evict(size_t need) {
+    while (gal.rows() && gal_free() < need) {
+        LittleFS.remove(gal_path(gal[gal_head][gal_id]));
+        gal_remove(gal_head);
+    }
+}
+
+// закончить копию: целая добавляется в таблицу, иначе удаляется
+void gal_copy_end(bool ok) {
+    if (!gal_copy.dst) return;
+    gal_copy.src.close();
+    gal_copy.dst.close();
+    if (!ok) {
+        LittleFS.remove(gal_path(gal_copy.id));
+        return;
+    }
+    gal.append(gal_copy.id, gal_copy.prompt, gal_copy.style, gal_copy.time, gal_copy.size);
+    gal_next_id++;
+}
+
+// начать копию новой картинки в галерею, дальше её по кускам ведёт gal_tick.
+// reserve - сколько места оставить свободным после копии
+bool gal_add(const char* path, uint32_t prompt, const String& style, size_t reserve) {
+    gal_copy_end(false);  // прошлая не успела до новой
+    File src = LittleFS.open(path, "r");
+    if (!src) return false;
+    size_t size = src.size();
+    gal_evict(size + reserve);
+    if (gal_free() < size + reserve) return false;
+
+    uint16_t id = gal_next_id;
+    File dst = LittleFS.open(gal_path(id), "w");
+    if (!dst) return false;
+    gal_copy.src = src;
+    gal_copy.dst = dst;
+    gal_copy.left = gal_copy.size = size;
+    gal_copy.id = id;
+    gal_copy.prompt = prompt;
+    strlcpy(gal_copy.style, style.c_str(), sizeof(gal_copy.style));
+    time_t now = time(nullptr);
+    gal_copy.time = now > 1600000000 ? (uint32_t)now : 0;
+    return true;
+}
+
+// идёт копия: источник (кэш последней картинки) нельзя перезаписывать новым показом
+bool gal_busy() {
+    return (bool)gal_copy.dst;
+}
+
+// показать следующую картинку галереи. false - галерея пуста или декодер занят
+bool gal_show(Kandinsky& gen) {
+    if (!gal.rows()) return false;
+    uint16_t id = gal[gal_head][gal_id];
+    if (!LittleFS.exists(gal_path(id))) {
+        gal_remove(gal_head);
+        return false;
+    }
+    if (!gen.showFile(gal_path(id))) return false;
+    gal_head = (gal_head + 1) % gal.rows();
+    db.set(kk::gal_head, gal_head);
+    return true;
+}
+
+void gal_tick() {
+    if (gal_copy.dst) {
+        uint8_t buf[512];
+        uint32_t tmr = millis();
+        while (gal_copy.left && millis() - tmr < GAL_SLICE) {
+            size_t n = gal_copy.src.read(buf, min(gal_copy.left, (uint32_t)sizeof(buf)));
+            if (!n || gal_copy.dst.write(buf, n) != n) return gal_copy_end(false);
+            gal_copy.left -= n;
+        }
+        if (!gal_copy.left) gal_copy_end(true);
+    }
+    gal.tick();
+}
@@ -1,26 +1,76 @@
 #pragma once
 #include "Kandinsky/Kandinsky.h"
-
 #include "config.h"
+#include "gallery.h"
 Kandinsky gen;
 bool gen_flag = 0;
+bool gen_fresh = 0;
+uint32_t gen_prefetch_tmr = 0;
+uint32_t gen_model_tmr = 0;
 
-void generate() {
+// следующая картинка. fresh - новая генерация мимо запаса (кнопка, промт мог смениться)
+void generate(bool fresh = false) {
     gen_flag = 1;
+    if (fresh) gen_fresh = 1;
+}
+
+String gen_style() {
+    return Text(gen.styles).getSub(db[kk::gen_style], ';').toString();
+}
+
+bool gen_start(Kandinsky::Dest dest, uint8_t images = 1) {
+    return gen.generate(
+        db[kk::gen_query],
+        GEN_WIDTH,
+        GEN_HEIGHT,
+        gen_style(),
+        db[kk::gen_negative],
+        dest,
+        images);
+}
+
+// API недоступен: нет сети или модель не получена (прокси лежит)
+bool gen_offline() {
+    return WiFi.status() != WL_CONNECTED || !gen.modelID().length();
+}
+
+// показанная картинка - в галерею. Промт и стиль текущие: пачка про запас заказана с ними же,
+// пока их не сменили кнопкой. Места оставляется на незаполненное кольцо запаса и временный файл
+void gen_cached(const char* path) {
+    size_t size = LittleFS.open(path, "r").size();
+    gal_add(path, db[kk::gen_query].hash(), gen_style(), size * (FUSION_RING - gen.parked() + 1) + GAL_RESERVE);
+}
+
+void gen_init() {
+    gen.onCache(gen_cached);
 }
 
 void gen_tick() {
     gen.tick();
+    gal_tick();
 
-    if (gen_flag) {
+    // новая генерация ждёт окончания текущего запроса и копии прошлой картинки в галерею
+    if (gen_flag && !gen.busy() && !gal_busy()) {
         gen_flag = 0;
+        if (gen_fresh) gen.clearNext();
+        bool next = !gen_fresh && gen.showNext();
+        // без сети - картинки из галереи по тому же расписанию
+        if (!next && gen_offline()) next = gal_show(gen);
+        if (!next) gen_start(Kandinsky::Dest::Show);
+        gen_fresh = 0;
+    }
 
-        gen.setScale(DISP_SCALE);
-        gen.generate(
-            db[kk::gen_query],
-            DISP_WIDTH * DISP_SCALE,
-            DISP_HEIGHT * DISP_SCALE,
-            Text(gen.styles).getSub(db[kk::gen_style], ';'),
-            db[kk::gen_negative]);
+    // сеть появилась после старта без неё: стили и модель
+    if (!gen.modelID().length() && WiFi.status() == WL_CONNECTED && !gen.busy() && millis() - gen_model_tmr >= GEN_PREFETCH_RETRY) {
+        gen_model_tmr = millis();
+        if (gen.getStyles()) gen.begin();
     }
-}
\ No newline at end of file
+
+    // автогенерация: пачка следующих картинок заказывается сразу после вывода текущей, когда кольцо
+    // во флеше опустело, и ждёт таймера там. Смена картинки - только локальный декод
+    if (db[kk::auto_gen].toBool() && !gen.busy() && !gen.queued() && !gen.parked() && !gen_offline() &&
+        millis() - gen_prefetch_tmr >= GEN_PREFETCH_RETRY) {
+        gen_prefetch_tmr = millis();
+        gen_start(Kandinsky::Dest::Park, GEN_BATCH);
+    }
+}
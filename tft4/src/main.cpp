@@ -14,6 +14,15 @@ void setup() {
     sett_init();
     tft_init();
 
+    // ======= CACHE =======
+    // последняя картинка с флешки, пока нет сети. Лог тогда только в Serial, чтобы не рисовать поверх
+    gen.setCache(&LittleFS, "/last.jpg");
+    gen.setNext("/next");
+    gen_init();
+    gal_init();
+    gen.setHistory(&db);
+    Print& out = gen.drawCache() ? (Print&)Serial : (Print&)tft;
+
     // ======= AI =======
     gen.setKey(db[kk::kand_token], db[kk::kand_secret]);
 
@@ -21,12 +30,12 @@ void setup() {
     WiFi.mode(WIFI_AP_STA);
     WiFi.softAP("Kandinsky AP");
     
-    tft.print("AiFrame v");
-    tft.println(F_VERSION);
-    tft.println("Kandinsky AP");
-    tft.print("IP: ");
-    tft.println(WiFi.softAPIP());
-    tft.println();
+    out.print("AiFrame v");
+    out.println(F_VERSION);
+    out.println("Kandinsky AP");
+    out.print("IP: ");
+    out.println(WiFi.softAPIP());
+    out.println();
 
     // ======= STA =======
     bool wifi_ok = false;
@@ -34,48 +43,50 @@ void setup() {
     if (db[kk::wifi_ssid].length()) {
         WiFi.begin(db[kk::wifi_ssid], db[kk::wifi_pass]);
         wifi_ok = true;
-        tft.print("Connecting");
+        out.print("Connecting");
         int tries = 20;
         while (WiFi.status() != WL_CONNECTED) {
             delay(500);
-            tft.print('.');
+            out.print('.');
             if (!--tries) {
                 wifi_ok = false;
                 break;
             }
         }
-        tft.println();
-        tft.print("IP: ");
-        tft.println(WiFi.localIP());
+        out.println();
+        out.print("IP: ");
+        out.println(WiFi.localIP());
+        configTime(0, 0, "pool.ntp.org");  // время картинок галереи (UTC)
     } else {
-        tft.println("STA not configured");
+        out.println("STA not configured");
     }
-    tft.println();
+    out.println();
 
+    // без сети картинки идут из галереи, модель запросится из gen_tick, когда сеть появится
     if (!wifi_ok) return;
 
     // ======= STYLES =======
-    tft.println("Gettings styles...");
+    out.println("Gettings styles...");
     if (gen.getStyles()) {
-        tft.print("OK. Styles: ");
-        tft.println(gen.styles);
+        out.print("OK. Styles: ");
+        out.println(gen.styles);
     } else {
-        tft.print("Error! ");
-        tft.println(gen.styles);
+        out.print("Error! ");
+        out.println(gen.styles);
     }
-    tft.println();
+    out.println();
 
     // ======= MODEL =======
-    tft.println("Init AI model...");
+    out.println("Init AI model...");
     if (gen.begin()) {
-        tft.print("OK. Model: ");
-        tft.println(gen.modelID());
+        out.print("OK. Model: ");
+        out.println(gen.modelID());
     } else {
-        tft.println("Error!");
+        out.println("Error!");
     }
-    tft.println();
+    out.println();
 
-    tft.println("Ready!");
+    out.println("Ready!");
     Serial.println("Ready!");
 
     if (WiFi.status() == WL_CONNECTED) ota.checkUpdate();
@@ -18,6 +18,64 @@ void init_tmr() {
     else gentmr.stop();
 }
 
+// запросов status: для последней картинки, медиана генерации, в среднем на картинку
+String poll_stats() {
+    String s;
+    s += gen.polls.requests;
+    if (gen.polls.median) {
+        s += ", ";
+        s += gen.polls.median;
+        s += " с";
+    }
+    if (gen.polls.images) {
+        s += ", ~";
+        s += String(float(gen.polls.total) / gen.polls.images, 1);
+    }
+    return s;
+}
+
+// фаза запроса: среднее / 90% / максимум
+String http_phase(const ghttp::Stats::Hist& h) {
+    if (!h.n) return "-";
+    String s;
+    s += h.avg();
+    s += " / ";
+    s += h.percentile(90);
+    s += " / ";
+    s += h.max;
+    s += " мс";
+    return s;
+}
+
+// запросов, ошибок, по открытому соединению, отправлено/принято
+String http_host(const ghttp::Stats::Host& h) {
+    String s;
+    s += h.requests;
+    s += ", ошибок ";
+    s += h.fails;
+    s += ", открытых ";
+    s += h.reused;
+    s += ", ";
+    s += h.out / 1024;
+    s += "/";
+    s += h.in / 1024;
+    s += " КБ";
+    return s;
+}
+
+// id надписей хоста h: фазы и сводка
+size_t http_id(uint8_t h, uint8_t i) {
+    return SH("http") + h * 8 + i;
+}
+
+const char* const http_phases[] = {"DNS", "Подключение", "Отправка", "Первый байт", "Тело"};
+// без GHTTP_DNS_API фаза DNS (первая) входит в подключение и не показывается
+#ifdef GHTTP_DNS_API
+#define HTTP_PHASE0 0
+#else
+#define HTTP_PHASE0 1
+#endif
+
 void build(sets::Builder& b) {
     {
         sets::Group g(b, "Генерация");
@@ -25,6 +83,8 @@ void build(sets::Builder& b) {
         b.Input(kk::gen_query, "Промт");
         b.Input(kk::gen_negative, "Исключить");
         b.Label(SH("status"), "Статус", gen.status);
+        b.Label(SH("polls"), "Опрос", poll_stats());
+        b.Label(SH("gallery"), "Галерея", String(gal.rows()));
         b.Button(SH("generate"), "Генерировать");
     }
     {
@@ -48,6 +108,20 @@ void build(sets::Builder& b) {
             b.Pass(kk::kand_secret, "Secret");
             b.Button(SH("api_save"), "Применить");
         }
+        {
+            sets::Menu m(b, "HTTP");
+            for (uint8_t h = 0; h < gen.http.size(); h++) {
+                const ghttp::Stats::Host& host = gen.http[h];
+                sets::Group g(b, host.host ? host.host : "Другие");
+                b.Label(http_id(h, GHTTP_PHASES), "Запросы", http_host(host));
+                for (uint8_t i = HTTP_PHASE0; i < GHTTP_PHASES; i++) {
+                    b.Label(http_id(h, i), http_phases[i], http_phase(host.phase[i]));
+                }
+            }
+            sets::Group g(b);
+            b.Button(SH("http_dump"), "В Serial");
+            b.Button(SH("http_reset"), "Сброс");
+        }
     }
 
     if (b.Confirm("update"_h)) ota.update();
@@ -56,7 +130,7 @@ void build(sets::Builder& b) {
     if (b.build.isAction()) {
         switch (b.build.id) {
             case SH("generate"):
-                generate();
+                generate(true);
                 init_tmr();
                 break;
             case SH("wifi_save"):
@@ -67,6 +141,13 @@ void build(sets::Builder& b) {
                 gen.setKey(db[kk::kand_token], db[kk::kand_secret]);
                 db.update();
                 break;
+            case SH("http_dump"):
+                Serial.print(gen.http);
+                break;
+            case SH("http_reset"):
+                gen.http.reset();
+                b.reload();
+                break;
             case kk::auto_gen:
             case kk::auto_prd:
                 init_tmr();
@@ -77,6 +158,12 @@ void build(sets::Builder& b) {
 
 void update(sets::Updater& u) {
     u.update(SH("status"), gen.status);
+    u.update(SH("polls"), poll_stats());
+    u.update(SH("gallery"), String(gal.rows()));
+    for (uint8_t h = 0; h < gen.http.size(); h++) {
+        u.update(http_id(h, GHTTP_PHASES), http_host(gen.http[h]));
+        for (uint8_t i = HTTP_PHASE0; i < GHTTP_PHASES; i++) u.update(http_id(h, i), http_phase(gen.http[h].phase[i]));
+    }
     if (ota.hasUpdate()) u.update("update"_h, "Доступно обновление. Обновить прошивку?");
 }
 
@@ -13,8 +13,27 @@
 
 Adafruit_ST7796S_kbv tft(TFT_CS, TFT_DC, TFT_RST);
 
+void tft_push(uint8_t* px, uint32_t n) {
+#ifdef ESP8266
+    SPI.writeBytes(px, n * 2);  // пиксели уже big-endian (gen.setSwapBytes), через FIFO блоками по 64 байта
+#else
+    tft.writePixels((uint16_t*)px, n);
+#endif
+}
+
+// одно окно и один пакет пикселей на полосу от декодера
 void tft_render(int x, int y, int w, int h, uint8_t* buf) {
-    tft.drawRGBBitmap(x, y, (uint16_t*)buf, w, h);
+    if (x >= tft.width() || y >= tft.height()) return;
+    int cw = min(w, tft.width() - x);
+    int ch = min(h, tft.height() - y);
+    tft.startWrite();
+    tft.setAddrWindow(x, y, cw, ch);
+    if (cw == w) {
+        tft_push(buf, cw * ch);
+    } else {
+        for (int i = 0; i < ch; i++) tft_push(buf + i * w * 2, cw);
+    }
+    tft.endWrite();
 }
 
 void tft_init() {
@@ -24,5 +43,9 @@ void tft_init() {
     tft.fillScreen(0x0000);
     tft.setTextColor(0x07E0);
     tft.setTextSize(2, 2);
+#ifdef ESP8266
+    gen.setSwapBytes(true);
+#endif
     gen.onRender(tft_render);
+    gen.setFrame(DISP_WIDTH, DISP_HEIGHT);
 }
\ No newline at end of file